@@ -51,7 +51,9 @@ typedef struct Item	Item;
 struct Item {
 	char*	string;
 	char*	retstring;
+	char*	match;
 	Item*	next_link;
+	Item*	next_match;
 	Item*	next;
 	Item*	prev;
 	int	len;
@@ -98,8 +100,9 @@ EXTERN Item*	histidx;
 EXTERN int	maxwidth;
 EXTERN int	result;
 
-EXTERN  char*	(*find)(const char*, const char*);
 EXTERN  int	(*compare)(const char*, const char*, size_t);
+EXTERN  bool	ignorecase;
+EXTERN  bool	fuzzy;
 
 EXTERN char*	prompt;
 EXTERN int	promptw;
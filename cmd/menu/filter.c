@@ -0,0 +1,142 @@
+/* Copyright ©2006-2009 Kris Maglione <fbsdaemon@gmail.com>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include <ctype.h>
+#include "fns.h"
+#define link _link
+
+/* Matches are ranked into NRank buckets, and the buckets are
+ * concatenated in order, so ranking costs O(matches).
+ */
+enum {
+	NRank = 32,
+};
+
+/* The items which matched the last filter, chained through
+ * next_match. When the filter is extended, only they are searched.
+ */
+static struct {
+	Item*	first;
+	char*	filter;
+	bool	valid;
+} last;
+
+static inline void
+splice(Item *i) {
+	i->next->prev = i->prev;
+	i->prev->next = i->next;
+}
+static inline void
+link(Item *i, Item *j) {
+	i->next = j;
+	j->prev = i;
+}
+
+char*
+filter_lower(char *s) {
+	char *p;
+
+	for(p=s; *p; p++)
+		*p = tolower((uchar)*p);
+	return s;
+}
+
+void
+filter_reset(void) {
+	last.valid = false;
+}
+
+static int
+rank_substr(Item *i, char *filter, int len) {
+	char *p;
+
+	p = strstr(i->match, filter);
+	if(p == nil)
+		return -1;
+	if(p != i->match)
+		return 2;
+	if(i->len == len)
+		return 0;
+	return 1;
+}
+
+/* Matches the filter as a subsequence of the item. Contiguous
+ * prefixes rank first, then contiguous substrings, then matches in
+ * order of the number of characters skipped.
+ */
+static int
+rank_fuzzy(Item *i, char *filter, int len) {
+	char *f, *p, *q;
+	int gaps, start;
+
+	USED(len);
+	if(*filter == '\0')
+		return i->len ? 1 : 0;
+
+	p = i->match;
+	gaps = 0;
+	start = 0;
+	for(f=filter; *f; f++) {
+		q = strchr(p, *f);
+		if(q == nil)
+			return -1;
+		if(f == filter)
+			start = q - p;
+		else
+			gaps += q - p;
+		p = q + 1;
+	}
+	if(start == 0 && gaps == 0 && *p == '\0')
+		return 0;
+	return min(1 + (start > 0) + 2 * gaps, NRank - 1);
+}
+
+Item*
+filter_list(Item *i, char *filter) {
+	static Item bucket[NRank];
+	Item *tail[NRank];
+	Item *next, *first, **matchp;
+	int (*rank)(Item*, char*, int);
+	int len, r, n;
+
+	if(ignorecase)
+		filter = freelater(filter_lower(estrdup(filter)));
+	len = strlen(filter);
+	rank = fuzzy ? rank_fuzzy : rank_substr;
+
+	/* Every match of the new filter also matched the old one. */
+	if(last.valid && !strncmp(filter, last.filter, strlen(last.filter)))
+		i = last.first;
+	else
+		for(next=i; next; next=next->next_link)
+			next->next_match = next->next_link;
+
+	for(n=0; n < NRank; n++)
+		tail[n] = &bucket[n];
+
+	first = nil;
+	matchp = &first;
+	for(; i; i=next) {
+		next = i->next_match;
+		r = rank(i, filter, len);
+		if(r < 0)
+			continue;
+		*matchp = i;
+		matchp = &i->next_match;
+		link(tail[r], i);
+		tail[r] = i;
+	}
+	*matchp = nil;
+
+	free(last.filter);
+	last.filter = estrdup(filter);
+	last.first = first;
+	last.valid = true;
+
+	for(n=0; n < NRank; n++)
+		link(tail[n], &bucket[(n + 1) % NRank]);
+	for(n=NRank-1; n >= 0; n--)
+		splice(&bucket[n]);
+	return bucket[0].next;
+}
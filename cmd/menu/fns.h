@@ -12,13 +12,17 @@ void	caret_insert(char*, bool);
 void	caret_move(int, int);
 void	caret_set(int, int);
 
+/* filter.c */
+Item*	filter_list(Item*, char*);
+char*	filter_lower(char*);
+void	filter_reset(void);
+
 /* history.c */
 void	history_dump(const char*, int);
 char*	history_search(int, char*, int);
 
 /* main.c */
 void	debug(int, const char*, ...);
-Item*	filter_list(Item*, char*);
 void	init_screens(int);
 void	update_filter(bool);
 void	update_input(void);
@@ -20,9 +20,33 @@ static Biobuf*	inbuf;
 static bool	alwaysprint;
 static char*	cmdsep;
 
+/* Only a sample of the items is measured up front, to estimate
+ * maxwidth. The rest are measured when they're first drawn.
+ */
+enum {
+	NSample = 128,
+	SampleStride = 1024,
+};
+static long	nsample;
+
+/* Completions read from a pipe are added as they arrive, so the menu
+ * is shown and usable before the input is exhausted.
+ */
+static struct {
+	char*	buf;
+	int	n;
+	int	size;
+	bool	header;
+	bool	streaming;
+	Item*	first;
+	Item**	tail;
+	long	nitems;
+	long	nfiltered;
+} in;
+
 static void
 usage(void) {
-	fatal("usage: wimenu -i [-h <history>] [-a <address>] [-p <prompt>] [-s <screen>]\n");
+	fatal("usage: wimenu [-fi] [-h <history>] [-a <address>] [-p <prompt>] [-s <screen>]\n");
 }
 
 static int
@@ -62,6 +86,32 @@ link(Item *i, Item *j) {
 	j->prev = i;
 }
 
+static Item*
+newitem(char *p, bool hist) {
+	Item *i;
+
+	i = emallocz(sizeof *i);
+	i->string = p;
+	i->retstring = p;
+	if(cmdsep && (p = strstr(p, cmdsep))) {
+		*p = '\0';
+		i->retstring = p + strlen(cmdsep);
+	}
+	i->match = i->string;
+	if(!hist) {
+		if(ignorecase)
+			i->match = filter_lower(estrdup(i->string));
+		i->len = strlen(i->string);
+		i->width = -1;
+		if(nsample++ < NSample || nsample % SampleStride == 0) {
+			i->width = textwidth_l(font, i->string, i->len);
+			if(i->width > maxwidth)
+				maxwidth = i->width;
+		}
+	}
+	return i;
+}
+
 static Item*
 populate_list(Biobuf *buf, bool hist) {
 	Item ret;
@@ -74,21 +124,9 @@ populate_list(Biobuf *buf, bool hist) {
 	while((p = Brdstr(buf, '\n', true))) {
 		if(stop && p[0] == '\0')
 			break;
-		link(i, emallocz(sizeof *i));
+		link(i, newitem(p, hist));
 		i->next_link = i->next;
 		i = i->next;
-		i->string = p;
-		i->retstring = p;
-		if(cmdsep && (p = strstr(p, cmdsep))) {
-			*p = '\0';
-			i->retstring = p + strlen(cmdsep);
-		}
-		if(!hist) {
-			i->len = strlen(i->string);
-			i->width = textwidth_l(font, i->string, i->len);
-			if(i->width > maxwidth)
-				maxwidth = i->width;
-		}
 	}
 
 	link(i, &ret);
@@ -96,53 +134,105 @@ populate_list(Biobuf *buf, bool hist) {
 	return ret.next != &ret ? ret.next : nil;
 }
 
-static void
-check_competions(IxpConn *c) {
-	char *s;
+static bool
+ismatch(Item *i) {
+	Item *j;
 
-	s = Brdstr(cmplbuf, '\n', true);
-	if(!s) {
-		ixp_hangup(c);
-		return;
+	for(j=matchfirst; j->string; j=j->next) {
+		if(j == i)
+			return true;
+		if(j->next == matchfirst)
+			break;
 	}
-	input.filter_start = strtol(s, nil, 10);
-	items = populate_list(cmplbuf, false);
+	return false;
+}
+
+/* The selection, and the page which shows it, are kept so long as
+ * they still match, so that new completions arriving don't move the
+ * user's place.
+ */
+static void
+refilter(void) {
+	Item *sel, *start;
+
+	sel = matchidx;
+	start = matchstart;
+	items = in.first;
+	in.nfiltered = in.nitems;
+	filter_reset();
 	update_filter(false);
+	if(sel && ismatch(sel)) {
+		matchidx = sel;
+		matchstart = ismatch(start) ? start : sel;
+		matchend = nil;
+	}
 	menu_draw();
 }
 
-Item*
-filter_list(Item *i, char *filter) {
-	static Item exact;
-	Item start, substr;
-	Item *exactp, *startp, *substrp;
-	Item **ip;
-	char *p;
-	int len;
-
-	len = strlen(filter);
-	exactp = &exact;
-	startp = &start;
-	substrp = &substr;
-	for(; i; i=i->next_link)
-		if((p = find(i->string, filter))) {
-			ip = &substrp;
-			if(p == i->string)
-				if(strlen(p) == len)
-					ip = &exactp;
-				else
-					ip = &startp;
-			link(*ip, i);
-			*ip = i;
+static void
+endlist(void) {
+	refilter();
+	in.first = nil;
+	in.tail = &in.first;
+	in.nitems = 0;
+	in.nfiltered = 0;
+	in.header = true;
+	in.streaming = false;
+}
+
+static void
+addline(char *s) {
+	Item *i;
+
+	if(in.header) {
+		input.filter_start = strtol(s, nil, 10);
+		in.header = false;
+		return;
+	}
+	if(s[0] == '\0') {
+		endlist();
+		return;
+	}
+	i = newitem(estrdup(s), false);
+	*in.tail = i;
+	in.tail = &i->next_link;
+	in.nitems++;
+}
+
+static void
+check_competions(IxpConn *c) {
+	char *p, *q, *e;
+	int n;
+
+	if(in.size - in.n < 4096) {
+		in.size = max(in.size * 2, 8192);
+		in.buf = erealloc(in.buf, in.size);
+	}
+	n = read(c->fd, in.buf + in.n, in.size - in.n - 1);
+	if(n <= 0) {
+		if(in.n > 0) {
+			in.buf[in.n] = '\0';
+			addline(in.buf);
 		}
+		if(!in.header)
+			endlist();
+		ixp_hangup(c);
+		return;
+	}
 
-	link(substrp, &exact);
-	link(startp,  &substr);
-	link(exactp,  &start);
-	splice(&substr);
-	splice(&start);
-	splice(&exact);
-	return exact.next;
+	e = in.buf + in.n + n;
+	for(p=in.buf; (q = memchr(p, '\n', e - p)); p=q+1) {
+		*q = '\0';
+		addline(p);
+	}
+	in.n = e - p;
+	memmove(in.buf, p, in.n);
+
+	/* Refiltering costs O(items), so doing it each time the list
+	 * doubles keeps the total linear.
+	 */
+	if(in.streaming && in.nitems >= 2 * in.nfiltered)
+		refilter();
 }
 
 void
@@ -230,7 +320,6 @@ main(int argc, char *argv[]) {
 	address = getenv("WMII_ADDRESS");
 	screen = PointerScreen;
 
-	find = strstr;
 	compare = strncmp;
 
 	ndump = -1;
@@ -245,8 +334,11 @@ main(int argc, char *argv[]) {
 	case 'h':
 		histfile = EARGF(usage());
 		break;
+	case 'f':
+		fuzzy = true;
+		break;
 	case 'i':
-		find = strcasestr;
+		ignorecase = true;
 		compare = strncasecmp;
 		break;
 	case 'K':
@@ -298,10 +390,14 @@ main(int argc, char *argv[]) {
 	if(!font)
 		fatal("Can't load font %q", readctl("font "));
 
-	cmplbuf = Bfdopen(0, OREAD);
-	items = populate_list(cmplbuf, false);
-	if(!isatty(cmplbuf->fid))
-		ixp_listen(&srv, cmplbuf->fid, inbuf, check_competions, nil);
+	if(isatty(0)) {
+		cmplbuf = Bfdopen(0, OREAD);
+		items = populate_list(cmplbuf, false);
+	}else {
+		in.tail = &in.first;
+		in.streaming = true;
+		ixp_listen(&srv, 0, nil, check_competions, nil);
+	}
 
 	caret_insert("", true);
 	update_filter(false);
@@ -10,6 +10,13 @@ static int	ltwidth;
 
 static void	_menu_draw(bool);
 
+static int
+itemwidth(Item *i) {
+	if(i->width < 0)
+		i->width = textwidth_l(font, i->string, i->len);
+	return i->width;
+}
+
 enum {
 	ACCEPT = CARET_LAST,
 	REJECT,
@@ -169,7 +176,7 @@ _menu_draw(bool draw) {
 		n = itemoff;
 		matchstart = matchend;
 		for(i=matchend; ; i=i->prev) {
-			n += i->width + pad;
+			n += itemwidth(i) + pad;
 			if(n > end)
 				break;
 			matchstart = i;
@@ -184,7 +191,7 @@ _menu_draw(bool draw) {
 	r2 = rd;
 	for(i=matchstart; i->string; i=i->next) {
 		r2.min.x = promptw + itemoff;
-		itemoff  = itemoff + i->width + pad;
+		itemoff  = itemoff + itemwidth(i) + pad;
 		r2.max.x = promptw + min(itemoff, end);
 		if(i != matchstart && itemoff > end)
 			break;
@@ -217,7 +217,7 @@ void
 refree(Regex *r) {
 
 	free(r->regex);
-	free(r->regc);
+	regfree(r->regc);
 	r->regex = nil;
 	r->regc = nil;
 }
@@ -201,6 +201,8 @@ area_destroy(Area *a) {
 	view_arrange(v);
 	event("DestroyArea %d\n", idx);
 
+	if(a->floating)
+		float_destroy(a);
 	free(a);
 }
 
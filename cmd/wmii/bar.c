@@ -41,6 +41,11 @@ bar_init(WMScreen *s) {
 
 void
 bar_resize(WMScreen *s) {
+	Bar *b;
+
+	/* The font may have changed. */
+	foreach_bar(s, b)
+		b->width = -1;
 
 	s->brect = s->r;
 	s->brect.min.y = s->r.max.y - labelh(def.font);
@@ -79,6 +84,28 @@ bar_sety(WMScreen *s, int y) {
 		reshapewin(s->barwin, *r);
 }
 
+/* Returns the name index of the bar list bp. */
+static Map*
+barmap(Bar **bp) {
+	WMScreen *s, **sp;
+	Map *m;
+	uint i;
+
+	for(sp=screens; (s = *sp); sp++) {
+		i = bp - s->bar;
+		if(i < nelem(s->bar)) {
+			m = &s->barmap[i];
+			if(m->bucket == nil) {
+				m->nhash = 137;
+				m->bucket = emallocz(m->nhash * sizeof *m->bucket);
+			}
+			return m;
+		}
+	}
+	die("Bar list not found");
+	return nil; /* shut up ken */
+}
+
 Bar*
 bar_create(Bar **bp, const char *name) {
 	static uint id = 1;
@@ -86,12 +113,13 @@ bar_create(Bar **bp, const char *name) {
 	Bar *b;
 	uint i;
 
-	b = bar_find(*bp, name);;
+	b = bar_find(bp, name);
 	if(b)
 		return b;
 
 	b = emallocz(sizeof *b);
 	b->id = id++;
+	b->width = -1;
 	utflcpy(b->name, name, sizeof b->name);
 	b->col = def.normcolor;
 
@@ -108,6 +136,8 @@ bar_create(Bar **bp, const char *name) {
 	b->bar = i;
 	b->screen = s;
 
+	*hash_get(barmap(bp), b->name, true) = b;
+
 	for(; *bp; bp = &bp[0]->next)
 		if(strcmp(bp[0]->name, name) >= 0)
 			break;
@@ -124,27 +154,35 @@ bar_destroy(Bar **bp, Bar *b) {
 	for(p = bp; *p; p = &p[0]->next)
 		if(*p == b) break;
 	*p = b->next;
+	hash_rm(barmap(bp), b->name);
 	free(b);
 }
 
 void
 bar_draw(WMScreen *s) {
 	Bar *b, *tb, *largest, **pb;
+	Image *img;
 	Rectangle r;
 	Align align;
+	uvlong t;
 	uint width, tw;
 	float shrink;
 
 	/* To do: Generalize this. */
 
+	s->dirty = false;
+	stats.bar_draw++;
+	t = trace_begin();
+
 	largest = nil;
 	width = 0;
 	foreach_bar(s, b) {
 		b->r.min = ZP;
 		b->r.max.y = Dy(s->brect);
 		b->r.max.x = (def.font->height & ~1) + def.font->pad.min.x + def.font->pad.max.x;
-		if(b->text && strlen(b->text))
-			b->r.max.x += textwidth(def.font, b->text);
+		if(b->width < 0)
+			b->width = b->text[0] ? textwidth(def.font, b->text) : 0;
+		b->r.max.x += b->width;
 		width += Dx(b->r);
 	}
 
@@ -183,17 +221,38 @@ bar_draw(WMScreen *s) {
 	}
 
 	r = rectsubpt(s->brect, s->brect.min);
-	fill(disp.ibuf, r, def.normcolor.bg);
-	border(disp.ibuf, r, 1, def.normcolor.border);
+	img = ibuf_get(Dx(r), Dy(r), s->barwin->depth);
+	fill(img, r, def.normcolor.bg);
+	border(img, r, 1, def.normcolor.border);
 	foreach_bar(s, b) {
 		align = Center;
 		if(b == s->bar[BRight])
 			align = East;
-		fill(disp.ibuf, b->r, b->col.bg);
-		drawstring(disp.ibuf, def.font, b->r, align, b->text, b->col.fg);
-		border(disp.ibuf, b->r, 1, b->col.border);
+		fill(img, b->r, b->col.bg);
+		drawstring(img, def.font, b->r, align, b->text, b->col.fg);
+		border(img, b->r, 1, b->col.border);
 	}
-	copyimage(s->barwin, r, disp.ibuf, ZP);
+	copyimage(s->barwin, r, img, ZP);
+	ibuf_put(img);
+	trace_end("draw", "bar_draw", t);
+}
+
+/* Schedules a redraw of s's bar. Bars are drawn at most once per
+ * pass through the event loop, by bar_flush.
+ */
+void
+bar_damage(WMScreen *s) {
+	stats.bar_damage++;
+	s->dirty = true;
+}
+
+void
+bar_flush(void) {
+	WMScreen **sp;
+
+	for(sp=screens; *sp; sp++)
+		if(sp[0]->dirty)
+			bar_draw(*sp);
 }
 
 void
@@ -217,17 +276,16 @@ bar_load(Bar *b) {
 	 strlcat(p, " ", sizeof b->buf);
 	 strlcat(p, b->text, sizeof b->buf);
 
-	 bar_draw(b->screen);
+	 b->width = -1;
+	 bar_damage(b->screen);
 }
 
 Bar*
-bar_find(Bar *bp, const char *name) {
-	Bar *b;
+bar_find(Bar **bp, const char *name) {
+	void **e;
 
-	for(b=bp; b; b=b->next)
-		if(!strcmp(b->name, name))
-			break;
-	return b;
+	e = hash_get(barmap(bp), name, false);
+	return e ? *e : nil;
 }
 
 static char *barside[] = {
@@ -288,7 +346,7 @@ dndmotion_event(Window *w, Point p) {
 static void
 expose_event(Window *w, XExposeEvent *e) {
 	USED(w, e);
-	bar_draw(w->aux);
+	bar_damage(w->aux);
 }
 
 static Handlers handlers = {
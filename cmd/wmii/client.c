@@ -12,6 +12,23 @@
 
 static Handlers handlers;
 
+static MapEnt*	cbucket[137];
+static Map	clientmap = { cbucket, nelem(cbucket) };
+
+/* Clients with regex tags. Only they can be affected by the creation
+ * of a new view.
+ */
+static Vector_ptr	tagreclients;
+
+static void	tagre_register(Client*, bool);
+static void	client_updatename(Client*);
+static void	prop_class(Client*);
+static void	prop_hints(Client*);
+static void	prop_normalhints(Client*);
+static void	prop_protocols(Client*);
+static void	prop_transient(Client*);
+static void	updatemwm(Client*);
+
 enum {
 	ClientMask = StructureNotifyMask
 		   | PropertyChangeMask
@@ -99,6 +116,7 @@ client_create(XWindow w, XWindowAttributes *wa) {
 
 	c = emallocz(sizeof *c);
 	c->fullscreen = -1;
+	c->tagreidx = -1;
 	c->border = wa->border_width;
 
 	c->r.min = Pt(wa->x, wa->y);
@@ -111,21 +129,18 @@ client_create(XWindow w, XWindowAttributes *wa) {
 
 	depth = scr.depth;
 	vis = scr.visual;
-	/* XXX: Multihead. */
-	c->ibuf = &ibuf;
 	if(render_argb_p(wa->visual)) {
 		depth = 32;
 		vis = render_visual;
-		c->ibuf = &ibuf32;
 	}
 
-	client_prop(c, xatom("WM_PROTOCOLS"));
-	client_prop(c, xatom("WM_TRANSIENT_FOR"));
-	client_prop(c, xatom("WM_NORMAL_HINTS"));
-	client_prop(c, xatom("WM_HINTS"));
-	client_prop(c, xatom("WM_CLASS"));
-	client_prop(c, xatom("WM_NAME"));
-	client_prop(c, xatom("_MOTIF_WM_HINTS"));
+	prop_protocols(c);
+	prop_transient(c);
+	prop_normalhints(c);
+	prop_hints(c);
+	prop_class(c);
+	client_updatename(c);
+	updatemwm(c);
 
 	XSetWindowBorderWidth(display, w, 0);
 	XAddToSaveSet(display, w);
@@ -174,6 +189,7 @@ client_create(XWindow w, XWindowAttributes *wa) {
 			*t = c;
 			break;
 		}
+	*map_get(&clientmap, w, true) = c;
 
 
 	/* 
@@ -264,6 +280,8 @@ client_destroy(Client *c) {
 			*tc = c->next;
 			break;
 		}
+	map_rm(&clientmap, c->w.xid);
+	tagre_register(c, false);
 
 	r = client_grav(c, ZR);
 
@@ -291,6 +309,8 @@ client_destroy(Client *c) {
 	refree(&c->tagre);
 	refree(&c->tagvre);
 	free(c->retags);
+	free(c->deco.tags);
+	frame_freebacking(c);
 
 	destroywindow(c->framewin);
 
@@ -323,10 +343,10 @@ selclient(void) {
 
 Client*
 win2client(XWindow w) {
-	Client *c;
-	for(c=client; c; c=c->next)
-		if(c->w.xid == w) break;
-	return c;
+	void **e;
+
+	e = map_get(&clientmap, w, false);
+	return e ? *e : nil;
 }
 
 int
@@ -431,7 +451,7 @@ static void
 client_setstate(Client * c, int state) {
 	long data[] = { state, None };
 
-	changeprop_long(&c->w, "WM_STATE", "WM_STATE", data, nelem(data));
+	publish_long(&c->w, "WM_STATE", "WM_STATE", data, nelem(data));
 }
 
 void
@@ -517,6 +537,14 @@ client_resize(Client *c, Rectangle r) {
 	f = c->sel;
 	frame_resize(f, r);
 
+	/* The window is configured by the view_update which ends the
+	 * batch.
+	 */
+	if(view_batching()) {
+		view_update(selview);
+		return;
+	}
+
 	if(f->view != selview) {
 		client_unmap(c, IconicState);
 		unmap_frame(c);
@@ -759,60 +787,103 @@ updatemwm(Client *c) {
 	}
 }
 
-void
-client_prop(Client *c, Atom a) {
+static void
+prop_protocols(Client *c) {
+	c->proto = ewmh_protocols(&c->w);
+}
+
+static void
+prop_transient(Client *c) {
+	long *l;
+
+	c->trans = 0;
+	if(getprop_long(&c->w, "WM_TRANSIENT_FOR", "WINDOW", 0L, &l, 1L))
+		c->trans = l[0];
+	free(l);
+}
+
+static void
+prop_normalhints(Client *c) {
 	WinHints h;
+
+	memset(&h, 0, sizeof h);
+	if(c->w.hints)
+		bcopy(c->w.hints, &h, sizeof h);
+	sethints(&c->w);
+	if(c->w.hints)
+		c->fixedsize = eqpt(c->w.hints->min, c->w.hints->max);
+	if(memcmp(&h, c->w.hints, sizeof h))
+	if(c->sel)
+		view_update(c->sel->view);
+}
+
+static void
+prop_hints(Client *c) {
 	XWMHints *wmh;
+
+	wmh = getprop_wmhints(&c->w);
+	if(wmh) {
+		c->noinput = (wmh->flags&InputFocus) && !wmh->input;
+		client_seturgent(c, (wmh->flags & XUrgencyHint) != 0, UrgClient);
+		free(wmh);
+	}
+}
+
+static void
+prop_class(Client *c) {
 	char **class;
 	int n;
 
-	if(a == xatom("WM_PROTOCOLS"))
-		c->proto = ewmh_protocols(&c->w);
-	else
-	if(a == xatom("_NET_WM_NAME"))
-		goto wmname;
-	else
-	if(a == xatom("_MOTIF_WM_HINTS"))
-		updatemwm(c);
-	else
-	switch (a) {
-	default:
-		ewmh_prop(c, a);
-		break;
-	case XA_WM_TRANSIENT_FOR:
-		XGetTransientForHint(display, c->w.xid, &c->trans);
-		break;
-	case XA_WM_NORMAL_HINTS:
-		memset(&h, 0, sizeof h);
-		if(c->w.hints)
-			bcopy(c->w.hints, &h, sizeof h);
-		sethints(&c->w);
-		if(c->w.hints)
-			c->fixedsize = eqpt(c->w.hints->min, c->w.hints->max);
-		if(memcmp(&h, c->w.hints, sizeof h))
-		if(c->sel)
-			view_update(c->sel->view);
-		break;
-	case XA_WM_HINTS:
-		wmh = XGetWMHints(display, c->w.xid);
-		if(wmh) {
-			c->noinput = (wmh->flags&InputFocus) && !wmh->input;
-			client_seturgent(c, (wmh->flags & XUrgencyHint) != 0, UrgClient);
-			XFree(wmh);
-		}
-		break;
-	case XA_WM_CLASS:
-		n = getprop_textlist(&c->w, "WM_CLASS", &class);
-		snprint(c->props, sizeof c->props, "%s:%s:",
-				(n > 0 ? class[0] : "<nil>"),
-				(n > 1 ? class[1] : "<nil>"));
-		freestringlist(class);
-		update_class(c);
-		break;
-	case XA_WM_NAME:
-wmname:
-		client_updatename(c);
-		break;
+	n = getprop_textlist(&c->w, "WM_CLASS", &class);
+	snprint(c->props, sizeof c->props, "%s:%s:",
+			(n > 0 ? class[0] : "<nil>"),
+			(n > 1 ? class[1] : "<nil>"));
+	freestringlist(class);
+	update_class(c);
+}
+
+/* Property handlers, by atom. Filled on first use, after ewmh_init
+ * has interned every atom.
+ */
+typedef struct PropHandler PropHandler;
+struct PropHandler {
+	char*	name;
+	void	(*f)(Client*);
+};
+
+static PropHandler prophandlers[] = {
+	{ "WM_CLASS",			prop_class },
+	{ "WM_HINTS",			prop_hints },
+	{ "WM_NAME",			client_updatename },
+	{ "WM_NORMAL_HINTS",		prop_normalhints },
+	{ "WM_PROTOCOLS",		prop_protocols },
+	{ "WM_TRANSIENT_FOR",		prop_transient },
+	{ "_MOTIF_WM_HINTS",		updatemwm },
+	{ "_NET_WM_NAME",		client_updatename },
+	{ "_NET_WM_STRUT_PARTIAL",	ewmh_getstrut },
+	{ "_NET_WM_WINDOW_TYPE",	ewmh_getwintype },
+};
+
+static MapEnt*	pbucket[37];
+static Map	propmap = { pbucket, nelem(pbucket) };
+
+void
+client_prop(Client *c, Atom a) {
+	static bool init;
+	PropHandler *h;
+	void **e;
+	int i;
+
+	if(!init) {
+		init = true;
+		for(i=0; i < nelem(prophandlers); i++)
+			*map_get(&propmap, xatom(prophandlers[i].name), true) = &prophandlers[i];
+	}
+
+	e = map_get(&propmap, a, false);
+	if(e) {
+		h = *e;
+		h->f(c);
 	}
 }
 
@@ -1052,6 +1123,47 @@ client_extratags(Client *c) {
 	return s;
 }
 
+/* Adds c to, or removes it from, the clients with regex tags. Each
+ * knows its place in the list by its tagreidx, -1 when it's absent.
+ */
+static void
+tagre_register(Client *c, bool add) {
+	Client *last;
+	int i;
+
+	i = c->tagreidx;
+	if(add && i == -1) {
+		c->tagreidx = tagreclients.n;
+		vector_ppush(&tagreclients, c);
+	}
+	if(!add && i != -1) {
+		last = tagreclients.ary[--tagreclients.n];
+		tagreclients.ary[i] = last;
+		last->tagreidx = i;
+		c->tagreidx = -1;
+	}
+}
+
+/* Retags the clients whose regex tags match the name of a newly
+ * created view.
+ */
+void
+apply_tagre(View *v) {
+	Client *c;
+	int i;
+
+	for(i=0; i < tagreclients.n; i++) {
+		c = tagreclients.ary[i];
+		if(c == kludge)
+			continue;
+		if(!regexec(c->tagre.regc, v->name, nil, 0))
+			continue;
+		if(c->tagvre.regc && regexec(c->tagvre.regc, v->name, nil, 0))
+			continue;
+		apply_tags(c, c->tags);
+	}
+}
+
 void
 apply_tags(Client *c, const char *tags) {
 	uint i, j, k, n;
@@ -1161,6 +1273,7 @@ apply_tags(Client *c, const char *tags) {
 		strlcatprint(c->tags, sizeof c->tags, "-/%s/", c->tagvre.regex);
 	changeprop_string(&c->w, "_WMII_TAGS", c->tags);
 	free(s);
+	tagre_register(c, c->tagre.regex != nil);
 
 	free(c->retags);
 	p = view_names();
@@ -1182,12 +1295,14 @@ apply_tags(Client *c, const char *tags) {
 void
 apply_rules(Client *c) {
 	Rule *r;
-
-	if(def.tagrules.string) 	
-		for(r=def.tagrules.rule; r; r=r->next)
-			if(regexec(r->regex, c->props, nil, 0)) {
-				apply_tags(c, r->value);
-				break;
-			}
+	uvlong t;
+
+	if(def.tagrules.string) {
+		t = trace_begin();
+		r = rule_match(&def.tagrules, c->props);
+		trace_end("rules", "tagrules", t);
+		if(r)
+			apply_tags(c, r->value);
+	}
 }
 
@@ -599,12 +599,14 @@ void
 column_arrange(Area *a, bool dirty) {
 	Frame *f;
 	View *v;
+	uvlong t;
 
 	if(a->floating)
 		float_arrange(a);
 	if(a->floating || !a->frame)
 		return;
 
+	t = stats_time();
 	v = a->view;
 
 	switch(a->mode) {
@@ -634,6 +636,8 @@ column_arrange(Area *a, bool dirty) {
 		for(f=a->frame; f; f=f->anext)
 			client_resize(f->client, f->r);
 	}
+	stats_add(&stats.column_arrange, stats_time() - t);
+	trace_end("layout", "column_arrange", t);
 }
 
 void
@@ -113,9 +113,13 @@ enum DebugOpt {
 typedef struct Area Area;
 typedef struct Bar Bar;
 typedef struct Client Client;
+typedef struct Decoration Decoration;
 typedef struct Divide Divide;
+typedef struct Edge Edge;
+typedef struct Edges Edges;
 typedef struct Frame Frame;
 typedef struct Group Group;
+typedef struct Histogram Histogram;
 typedef struct Key Key;
 typedef struct Map Map;
 typedef struct MapEnt MapEnt;
@@ -126,6 +130,21 @@ typedef struct Strut Strut;
 typedef struct View View;
 typedef struct WMScreen WMScreen;
 
+/* See edge.c */
+struct Edge {
+	int	v;
+	int	lo;
+	int	hi;
+	void*	key;
+};
+
+struct Edges {
+	Edge*	x;
+	Edge*	y;
+	int	n;
+	int	size;
+};
+
 struct Area {
 	Area*	next;
 	Area*	prev;
@@ -139,6 +158,7 @@ struct Area {
 	int	mode;
 	int	screen;
 	bool	max;
+	Edges	edges;
 	Rectangle	r;
 	Rectangle	r_old;
 };
@@ -150,6 +170,7 @@ struct Bar {
 	char	text[256];
 	char	name[256];
 	int	bar;
+	int	width;
 	ushort	id;
 	CTuple	col;
 	Rectangle	r;
@@ -161,19 +182,37 @@ struct Regex {
 	Reprog*	regc;
 };
 
+/* The state of a frame window's decorations, as last drawn. */
+struct Decoration {
+	Rectangle	r;
+	Rectangle	crect;
+	char	colstr[24];
+	char	label[256];
+	char	count[24];
+	char*	tags;
+	int	focus;
+	bool	border;
+	bool	floating;
+	bool	room;
+	bool	urgent;
+	bool	valid;
+};
+
 struct Client {
 	Client*	next;
 	Frame*	frame;
 	Frame*	sel;
 	Window	w;
 	Window*	framewin;
-	Image**	ibuf;
+	Window*	titlewin;
+	Image*	backing;
 	XWindow	trans;
 	Regex	tagre;
 	Regex	tagvre;
 	Group*	group;
 	Strut*	strut;
 	Cursor	cursor;
+	Decoration	deco;
 	Rectangle r;
 	char**	retags;
 	char	name[256];
@@ -183,6 +222,7 @@ struct Client {
 	uint	border;
 	int	fullscreen;
 	int	unmapped;
+	int	tagreidx;
 	char	floating;
 	char	fixedsize;
 	char	urgent;
@@ -224,6 +264,8 @@ struct Frame {
 	Rectangle	crect;
 	Rectangle	grabbox;
 	Rectangle	titlebar;
+	Rectangle	indexr;
+	bool	indexed;
 };
 
 struct Group {
@@ -257,6 +299,7 @@ struct Rule {
 
 struct Ruleset {
 	Rule*	rule;
+	Reset*	set;
 	char*	string;
 	uint	size;
 };
@@ -307,6 +350,17 @@ VECTOR(void*, ptr, p)
 #  define EXTERN extern
 #endif
 
+enum {
+	NHistogram = 20,
+};
+
+struct Histogram {
+	ulong	count;
+	uvlong	total;
+	ulong	max;
+	ulong	bucket[NHistogram];
+};
+
 /* global variables */
 EXTERN struct {
 	CTuple	focuscolor;
@@ -322,6 +376,8 @@ EXTERN struct {
 	uint	snap;
 	int	colmode;
 	int	incmode;
+	bool	framebacking;
+	bool	opaquemove;
 } def;
 
 enum {
@@ -332,8 +388,10 @@ enum {
 
 EXTERN struct WMScreen {
 	Bar*	bar[2];
+	Map	barmap[2];
 	Window*	barwin;
 	bool	showing;
+	bool	dirty;
 	int	barpos;
 	int	idx;
 
@@ -342,11 +400,30 @@ EXTERN struct WMScreen {
 } **screens, *screen;
 EXTERN uint	nscreens;
 
+/* See stats.c */
+EXTERN struct {
+	ulong		nrequest[14];
+	Histogram	ninep[14];
+	Histogram	event[LASTEvent];
+	Histogram	xrequests;
+	Histogram	queue;
+	Histogram	view_arrange;
+	Histogram	column_arrange;
+	ulong		view_update;
+	ulong		view_restack;
+	ulong		frame_draw;
+	ulong		bar_damage;
+	ulong		bar_draw;
+	ulong		motion_compressed;
+	ulong		ibuf_alloc;
+	ulong		ibuf_hit;
+	ulong		ibuf_count;
+	ulong		ibuf_bytes;
+} stats;
+
 EXTERN struct {
 	Client*	focus;
 	Client*	hasgrab;
-	Image*	ibuf;
-	Image*	ibuf32;
 	bool	sel;
 } disp;
 
@@ -376,8 +453,6 @@ EXTERN Ixp9Srv	p9srv;
 /* X11 */
 EXTERN uint	valid_mask;
 EXTERN uint	numlock_mask;
-EXTERN Image*	ibuf;
-EXTERN Image*	ibuf32;
 
 EXTERN Cursor	cursor[CurLast];
 
@@ -0,0 +1,110 @@
+/* Copyright ©2009 Kris Maglione <maglione.k at Gmail>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include "fns.h"
+
+/* An index of the edges of a set of rectangles, for snapping.
+ * Vertical edges are kept sorted by x, and horizontal ones by y,
+ * so that those near a given line are found by a binary search,
+ * and only they need be looked at. Each rectangle is known by a
+ * key, which queries may ask to have ignored.
+ */
+
+/* Returns the index of the first edge in e at or after v. */
+static int
+edge_search(Edge *e, int n, int v) {
+	int lo, hi, m;
+
+	lo = 0;
+	hi = n;
+	while(lo < hi) {
+		m = (lo + hi) / 2;
+		if(e[m].v < v)
+			lo = m + 1;
+		else
+			hi = m;
+	}
+	return lo;
+}
+
+static void
+edge_insert(Edge *e, int n, int v, int lo, int hi, void *key) {
+	int i;
+
+	i = edge_search(e, n, v);
+	memmove(&e[i+1], &e[i], (n - i) * sizeof *e);
+	e[i].v = v;
+	e[i].lo = lo;
+	e[i].hi = hi;
+	e[i].key = key;
+}
+
+static bool
+edge_delete(Edge *e, int n, int v, void *key) {
+	int i;
+
+	for(i=edge_search(e, n, v); i < n && e[i].v == v; i++)
+		if(e[i].key == key) {
+			memmove(&e[i], &e[i+1], (n - i - 1) * sizeof *e);
+			return true;
+		}
+	return false;
+}
+
+void
+edges_add(Edges *ed, Rectangle r, void *key) {
+
+	if(ed->n + 2 > ed->size) {
+		ed->size = max(ed->size * 2, 16);
+		ed->x = erealloc(ed->x, ed->size * sizeof *ed->x);
+		ed->y = erealloc(ed->y, ed->size * sizeof *ed->y);
+	}
+	edge_insert(ed->x, ed->n, r.min.x, r.min.y, r.max.y, key);
+	edge_insert(ed->x, ed->n+1, r.max.x, r.min.y, r.max.y, key);
+	edge_insert(ed->y, ed->n, r.min.y, r.min.x, r.max.x, key);
+	edge_insert(ed->y, ed->n+1, r.max.y, r.min.x, r.max.x, key);
+	ed->n += 2;
+}
+
+/* r must be the rectangle key was added with. If any of its edges
+ * can't be found, returns false, and the index must be freed and
+ * built anew.
+ */
+bool
+edges_remove(Edges *ed, Rectangle r, void *key) {
+
+	if(!edge_delete(ed->x, ed->n, r.min.x, key)
+	|| !edge_delete(ed->x, ed->n-1, r.max.x, key)
+	|| !edge_delete(ed->y, ed->n, r.min.y, key)
+	|| !edge_delete(ed->y, ed->n-1, r.max.y, key))
+		return false;
+	ed->n -= 2;
+	return true;
+}
+
+void
+edges_free(Edges *ed) {
+	free(ed->x);
+	free(ed->y);
+	memset(ed, 0, sizeof *ed);
+}
+
+/* Finds the edge nearest v, no further than d from it, whose
+ * extent overlaps lo-hi: a vertical one when vert is true, and
+ * otherwise a horizontal one. Returns the distance to it, or d if
+ * there's none.
+ */
+int
+edges_snap(Edges *ed, bool vert, int v, int lo, int hi, int d, void *ignore) {
+	Edge *e;
+	int i, n;
+
+	e = vert ? ed->x : ed->y;
+	n = ed->n;
+	for(i=edge_search(e, n, v - abs(d)); i < n && e[i].v <= v + abs(d); i++)
+		if(e[i].key != ignore && e[i].lo <= hi && e[i].hi >= lo)
+			if(abs(e[i].v - v) <= abs(d))
+				d = e[i].v - v;
+	return d;
+}
@@ -7,14 +7,66 @@
 
 typedef void (*EvHandler)(XEvent*);
 
+static char* evnames[LASTEvent] = {
+	[KeyPress] = "KeyPress",
+	[KeyRelease] = "KeyRelease",
+	[ButtonPress] = "ButtonPress",
+	[ButtonRelease] = "ButtonRelease",
+	[MotionNotify] = "MotionNotify",
+	[EnterNotify] = "EnterNotify",
+	[LeaveNotify] = "LeaveNotify",
+	[FocusIn] = "FocusIn",
+	[FocusOut] = "FocusOut",
+	[KeymapNotify] = "KeymapNotify",
+	[Expose] = "Expose",
+	[GraphicsExpose] = "GraphicsExpose",
+	[NoExpose] = "NoExpose",
+	[VisibilityNotify] = "VisibilityNotify",
+	[CreateNotify] = "CreateNotify",
+	[DestroyNotify] = "DestroyNotify",
+	[UnmapNotify] = "UnmapNotify",
+	[MapNotify] = "MapNotify",
+	[MapRequest] = "MapRequest",
+	[ReparentNotify] = "ReparentNotify",
+	[ConfigureNotify] = "ConfigureNotify",
+	[ConfigureRequest] = "ConfigureRequest",
+	[GravityNotify] = "GravityNotify",
+	[ResizeRequest] = "ResizeRequest",
+	[CirculateNotify] = "CirculateNotify",
+	[CirculateRequest] = "CirculateRequest",
+	[PropertyNotify] = "PropertyNotify",
+	[SelectionClear] = "SelectionClear",
+	[SelectionRequest] = "SelectionRequest",
+	[SelectionNotify] = "SelectionNotify",
+	[ColormapNotify] = "ColormapNotify",
+	[ClientMessage] = "ClientMessage",
+	[MappingNotify] = "MappingNotify",
+};
+
+char*
+eventname(int type) {
+	if(type < 0 || type >= nelem(evnames))
+		return nil;
+	return evnames[type];
+}
+
 void
 dispatch_event(XEvent *e) {
+	ulong nreq;
+	uvlong t;
+
 	Dprint(DEvent, "%E\n", e);
+	nreq = NextRequest(display);
+	t = stats_time();
 	if(e->type < nelem(handler)) {
 		if(handler[e->type])
 			handler[e->type](e);
 	}else
 		xext_event(e);
+	if(e->type < nelem(stats.event))
+		stats_add(&stats.event[e->type], stats_time() - t);
+	trace_end("event", eventname(e->type) ? eventname(e->type) : "XExtension", t);
+	stats_add(&stats.xrequests, NextRequest(display) - nreq);
 }
 
 #define handle(w, fn, ev) \
@@ -352,6 +404,7 @@ check_x_event(IxpConn *c) {
 
 	USED(c);
 	while(XPending(display)) {
+		stats_add(&stats.queue, QLength(display));
 		XNextEvent(display, &ev);
 		dispatch_event(&ev);
 	}
@@ -19,12 +19,72 @@ static void	ewmh_setstate(Client*, Atom, int);
 #define	STATE(x) xatom(State(x))
 #define	TYPE(x) xatom(Type(x))
 
+/* Every atom wmii knows of, interned in one round trip. */
+static char*	atomnames[] = {
+	"ATOM",
+	"CARDINAL",
+	"UTF8_STRING",
+	"WINDOW",
+	"WM_CLASS",
+	"WM_CLIENT_LEADER",
+	"WM_DELETE_WINDOW",
+	"WM_HINTS",
+	"WM_NAME",
+	"WM_NORMAL_HINTS",
+	"WM_PROTOCOLS",
+	"WM_SIZE_HINTS",
+	"WM_STATE",
+	"WM_TAKE_FOCUS",
+	"WM_TRANSIENT_FOR",
+	"XdndAware",
+	"XdndEnter",
+	"XdndLeave",
+	"XdndPosition",
+	"XdndStatus",
+	"_MOTIF_WM_HINTS",
+	"_WMII_TAGS",
+	Net("ACTIVE_WINDOW"),
+	Net("CLIENT_LIST"),
+	Net("CLIENT_LIST_STACKING"),
+	Net("CLOSE_WINDOW"),
+	Net("CURRENT_DESKTOP"),
+	Net("DESKTOP_NAMES"),
+	Net("DESKTOP_VIEWPORT"),
+	Net("FRAME_EXTENTS"),
+	Net("NUMBER_OF_DESKTOPS"),
+	Net("SUPPORTED"),
+	Net("SUPPORTING_WM_CHECK"),
+	Net("WM_ALLOWED_ACTIONS"),
+	Net("WM_DESKTOP"),
+	Net("WM_FULLSCREEN_MONITORS"),
+	Net("WM_NAME"),
+	Net("WM_PING"),
+	Net("WM_STATE"),
+	Net("WM_STRUT"),
+	Net("WM_STRUT_PARTIAL"),
+	Net("WM_WINDOW_TYPE"),
+	Action("FULLSCREEN"),
+	State("DEMANDS_ATTENTION"),
+	State("FULLSCREEN"),
+	State("SHADED"),
+	Type("DESKTOP"),
+	Type("DIALOG"),
+	Type("DOCK"),
+	Type("MENU"),
+	Type("NORMAL"),
+	Type("SPLASH"),
+	Type("TOOLBAR"),
+	Type("UTILITY"),
+};
+
 void
 ewmh_init(void) {
 	WinAttr wa;
 	char myname[] = "wmii";
 	long win;
 
+	xatoms(atomnames, nelem(atomnames));
+
 	ewmhwin = createwindow(&scr.root,
 		Rect(0, 0, 1, 1), 0 /*depth*/,
 		InputOnly, &wa, 0);
@@ -84,7 +144,7 @@ ewmh_updateclientlist(void) {
 	vector_linit(&vec);
 	for(c=client; c; c=c->next)
 		vector_lpush(&vec, c->w.xid);
-	changeprop_long(&scr.root, Net("CLIENT_LIST"), "WINDOW", vec.ary, vec.n);
+	publish_long(&scr.root, Net("CLIENT_LIST"), "WINDOW", vec.ary, vec.n);
 	free(vec.ary);
 }
 
@@ -112,7 +172,7 @@ ewmh_updatestacking(void) {
 				vector_lpush(&vec, f->client->w.xid);
 	}
 
-	changeprop_long(&scr.root, Net("CLIENT_LIST_STACKING"), "WINDOW", vec.ary, vec.n);
+	publish_long(&scr.root, Net("CLIENT_LIST_STACKING"), "WINDOW", vec.ary, vec.n);
 	vector_lfree(&vec);
 }
 
@@ -122,7 +182,7 @@ ewmh_initclient(Client *c) {
 		ACTION("FULLSCREEN"),
 	};
 
-	changeprop_long(&c->w, Net("WM_ALLOWED_ACTIONS"), "ATOM",
+	publish_long(&c->w, Net("WM_ALLOWED_ACTIONS"), "ATOM",
 		allowed, nelem(allowed));
 	ewmh_getwintype(c);
 	ewmh_getwinstate(c);
@@ -135,6 +195,7 @@ ewmh_destroyclient(Client *c) {
 	Ewmh *e;
 
 	ewmh_updateclientlist();
+	unpublish(&c->w);
 
 	e = &c->w.ewmh;
 	if(e->timer)
@@ -170,18 +231,6 @@ ewmh_pingclient(Client *c) {
 	e->timer = ixp_settimer(&srv, PingTime, pingtimeout, c);
 }
 
-int
-ewmh_prop(Client *c, Atom a) {
-	if(a == NET("WM_WINDOW_TYPE"))
-		ewmh_getwintype(c);
-	else
-	if(a == NET("WM_STRUT_PARTIAL"))
-		ewmh_getstrut(c);
-	else
-		return 0;
-	return 1;
-}
-
 typedef struct Prop Prop;
 struct Prop {
 	char*	name;
@@ -441,8 +490,8 @@ ewmh_framesize(Client *c) {
 		r.min.x, r.max.x,
 		r.min.y, r.max.y,
 	};
-	changeprop_long(&c->w, Net("FRAME_EXTENTS"), "CARDINAL",
-			extents, nelem(extents));
+	publish_long(&c->w, Net("FRAME_EXTENTS"), "CARDINAL",
+		extents, nelem(extents));
 }
 
 void
@@ -463,18 +512,15 @@ ewmh_updatestate(Client *c) {
 	if(c->urgent)
 		state[i++] = STATE("DEMANDS_ATTENTION");
 
-	if(i > 0)
-		changeprop_long(&c->w, Net("WM_STATE"), "ATOM", state, i);
-	else
-		delproperty(&c->w, Net("WM_STATE"));
+	publish_long(&c->w, Net("WM_STATE"), "ATOM", state, i > 0 ? i : -1);
 
 	if(c->fullscreen >= 0)
-		changeprop_long(&c->w, Net("WM_FULLSCREEN_MONITORS"), "CARDINAL",
-				(long[]) { c->fullscreen, c->fullscreen,
-					   c->fullscreen, c->fullscreen }, 
-				4);
+		publish_long(&c->w, Net("WM_FULLSCREEN_MONITORS"), "CARDINAL",
+			(long[]) { c->fullscreen, c->fullscreen,
+				   c->fullscreen, c->fullscreen }, 
+			4);
 	else
-		delproperty(&c->w, Net("WM_FULLSCREEN_MONITORS"));
+		publish_long(&c->w, Net("WM_FULLSCREEN_MONITORS"), nil, nil, -1);
 }
 
 /* Views */
@@ -492,7 +538,7 @@ ewmh_updateviews(void) {
 		vector_ppush(&tags, v->name);
 	vector_ppush(&tags, nil);
 	changeprop_textlist(&scr.root, Net("DESKTOP_NAMES"), "UTF8_STRING", (char**)tags.ary);
-	changeprop_long(&scr.root, Net("NUMBER_OF_DESKTOPS"), "CARDINAL", &i, 1);
+	publish_long(&scr.root, Net("NUMBER_OF_DESKTOPS"), "CARDINAL", &i, 1);
 	vector_pfree(&tags);
 	ewmh_updateview();
 	ewmh_updateclients();
@@ -518,7 +564,7 @@ ewmh_updateview(void) {
 		return;
 
 	i = viewidx(selview);
-	changeprop_long(&scr.root, Net("CURRENT_DESKTOP"), "CARDINAL", &i, 1);
+	publish_long(&scr.root, Net("CURRENT_DESKTOP"), "CARDINAL", &i, 1);
 }
 
 void
@@ -528,7 +574,7 @@ ewmh_updateclient(Client *c) {
 	i = -1;
 	if(c->sel)
 		i = viewidx(c->sel->view);
-	changeprop_long(&c->w, Net("WM_DESKTOP"), "CARDINAL", &i, 1);
+	publish_long(&c->w, Net("WM_DESKTOP"), "CARDINAL", &i, 1);
 }
 
 void
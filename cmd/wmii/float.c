@@ -6,6 +6,19 @@
 #include "fns.h"
 
 static void float_placeframe(Frame*);
+static void float_unindex(Area*, Frame*);
+static void space_sub(Vector_rect*, Rectangle);
+
+/* The empty space on one area's floating layer, within one
+ * rectangle, as the maximal rectangles which cover it. It's kept up
+ * to date as frames are added, and worked out afresh only when one
+ * moves or goes away.
+ */
+static struct {
+	Area*		area;
+	Rectangle	r;
+	Vector_rect	vec;
+} space;
 
 void
 float_attach(Area *a, Frame *f) {
@@ -33,6 +46,7 @@ float_detach(Frame *f) {
 	oldsel = v->oldsel;
 	pr = f->aprev;
 
+	float_unindex(a, f);
 	frame_remove(f);
 
 	if(a->sel == f) {
@@ -83,6 +97,69 @@ float_arrange(Area *a) {
 	view_update(a->view);
 }
 
+/* Frees what's kept for a, which is about to be freed. */
+void
+float_destroy(Area *a) {
+
+	edges_free(&a->edges);
+	if(space.area == a)
+		space.area = nil;
+}
+
+/* Drops a's index, which has been found not to match its frames.
+ * float_sync builds it anew.
+ */
+static void
+float_reindex(Area *a) {
+	Frame *f;
+
+	warning("floating index of %s is corrupt; rebuilding", a->view->name);
+	edges_free(&a->edges);
+	for(f=a->frame; f; f=f->anext)
+		f->indexed = false;
+	if(space.area == a)
+		space.area = nil;
+}
+
+/* Brings the index of a's frames up to date, touching only those
+ * which have moved since it was last called.
+ */
+void
+float_sync(Area *a) {
+	Frame *f;
+
+	for(f=a->frame; f; f=f->anext) {
+		if(f->indexed && eqrect(f->indexr, f->r))
+			continue;
+		if(f->indexed) {
+			if(!edges_remove(&a->edges, f->indexr, f)) {
+				float_reindex(a);
+				float_sync(a);
+				return;
+			}
+			if(space.area == a)
+				space.area = nil;
+		}
+		edges_add(&a->edges, f->r, f);
+		f->indexr = f->r;
+		f->indexed = true;
+		if(space.area == a)
+			space_sub(&space.vec, f->r);
+	}
+}
+
+static void
+float_unindex(Area *a, Frame *f) {
+
+	if(!f->indexed)
+		return;
+	if(!edges_remove(&a->edges, f->indexr, f))
+		float_reindex(a);
+	f->indexed = false;
+	if(space.area == a)
+		space.area = nil;
+}
+
 static void
 rect_push(Vector_rect *vec, Rectangle r) {
 	Rectangle *rp;
@@ -100,6 +177,54 @@ rect_push(Vector_rect *vec, Rectangle r) {
 	vector_rpush(vec, r);
 }
 
+/* Like rect_push, but drops every rectangle r contains. */
+static void
+frag_push(Vector_rect *vec, Rectangle r) {
+	int i, n;
+
+	for(i=0; i < vec->n; i++)
+		if(rect_contains_p(vec->ary[i], r))
+			return;
+	n = 0;
+	for(i=0; i < vec->n; i++)
+		if(!rect_contains_p(r, vec->ary[i]))
+			vec->ary[n++] = vec->ary[i];
+	vec->n = n;
+	vector_rpush(vec, r);
+}
+
+/* Takes r1 out of the empty space in vec. Only the rectangles which
+ * touch it need be split, and since each piece touches it too, only
+ * they could contain one.
+ */
+static void
+space_sub(Vector_rect *vec, Rectangle r1) {
+	static Vector_rect frag;
+	Rectangle r2;
+	int i, n;
+
+	frag.n = 0;
+	n = 0;
+	for(i=0; i < vec->n; i++) {
+		r2 = vec->ary[i];
+		if(!rect_intersect_p(r1, r2)) {
+			vec->ary[n++] = r2;
+			continue;
+		}
+		if(r2.min.x < r1.min.x)
+			frag_push(&frag, Rect(r2.min.x, r2.min.y, r1.min.x, r2.max.y));
+		if(r2.min.y < r1.min.y)
+			frag_push(&frag, Rect(r2.min.x, r2.min.y, r2.max.x, r1.min.y));
+		if(r2.max.x > r1.max.x)
+			frag_push(&frag, Rect(r1.max.x, r2.min.y, r2.max.x, r2.max.y));
+		if(r2.max.y > r1.max.y)
+			frag_push(&frag, Rect(r2.min.x, r1.max.y, r2.max.x, r2.max.y));
+	}
+	vec->n = n;
+	for(i=0; i < frag.n; i++)
+		vector_rpush(vec, frag.ary[i]);
+}
+
 Vector_rect*
 unique_rects(Vector_rect *vec, Rectangle orig) {
 	static Vector_rect vec1, vec2;
@@ -156,7 +281,6 @@ max_rect(Vector_rect *vec) {
 
 static void
 float_placeframe(Frame *f) {
-	static Vector_rect vec;
 	Vector_rect *vp;
 	Rectangle r;
 	Point dim, p;
@@ -179,18 +303,6 @@ float_placeframe(Frame *f) {
 		return;
 	}
 
-	/* Find all rectangles on the floating layer into which
-	 * the new frame would fit.
-	 */
-	vec.n = 0;
-	for(ff=a->frame; ff; ff=ff->anext)
-		/* TODO: Find out why this check is needed.
-		 * The frame hasn't been inserted yet, but somehow,
-		 * its old rectangle winds up in the list.
-		 */
-		if(ff->client != f->client)
-			vector_rpush(&vec, ff->r);
-
 	/* Decide which screen we want to place this on.
 	 * Ideally, it should probably Do the Right Thing
 	 * when a screen fills, but what's the right thing?
@@ -210,8 +322,30 @@ float_placeframe(Frame *f) {
 			s = sel->screen;
 	}
 
+	/* Find all rectangles on the floating layer into which
+	 * the new frame would fit.
+	 */
 	r = s == -1 ? a->r : screens[s]->r;
-	vp = unique_rects(&vec, r);
+	float_sync(a);
+	for(ff=c->frame; ff; ff=ff->cnext)
+		if(ff->area == a && ff->indexed)
+			break;
+	if(space.area != a || !eqrect(space.r, r) || ff) {
+		space.area = a;
+		space.r = r;
+		space.vec.n = 0;
+		vector_rpush(&space.vec, r);
+		for(ff=a->frame; ff; ff=ff->anext)
+			/* TODO: Find out why this check is needed.
+			 * The frame hasn't been inserted yet, but somehow,
+			 * its old rectangle winds up in the list.
+			 */
+			if(ff->client != f->client)
+				space_sub(&space.vec, ff->r);
+			else
+				space.area = nil;
+	}
+	vp = &space.vec;
 
 	area = LONG_MAX;
 	dim.x = Dx(f->r);
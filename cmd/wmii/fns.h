@@ -57,9 +57,11 @@ void	area_setsel(Area*, Frame*);
 
 /* bar.c */
 Bar*	bar_create(Bar**, const char*);
+void	bar_damage(WMScreen*);
 void	bar_destroy(Bar**, Bar*);
 void	bar_draw(WMScreen*);
-Bar*	bar_find(Bar*, const char*);
+Bar*	bar_find(Bar**, const char*);
+void	bar_flush(void);
 void	bar_init(WMScreen*);
 void	bar_load(Bar*);
 void	bar_resize(WMScreen*);
@@ -69,6 +71,7 @@ void	bar_setbounds(WMScreen*, int, int);
 /* client.c */
 int	Cfmt(Fmt *f);
 void	apply_rules(Client*);
+void	apply_tagre(View*);
 void	apply_tags(Client*, const char*);
 void	client_configure(Client*);
 Client*	client_create(XWindow, XWindowAttributes*);
@@ -122,9 +125,16 @@ bool	find(Area**, Frame**, int, bool, bool);
 int	stack_count(Frame*, int*);
 Frame*	stack_find(Area*, Frame*, int, bool);
 
+/* edge.c */
+void	edges_add(Edges*, Rectangle, void*);
+void	edges_free(Edges*);
+bool	edges_remove(Edges*, Rectangle, void*);
+int	edges_snap(Edges*, bool vert, int v, int lo, int hi, int d, void *ignore);
+
 /* event.c */
 void	check_x_event(IxpConn*);
 void	dispatch_event(XEvent*);
+char*	eventname(int);
 uint	flushenterevents(void);
 uint	flushevents(long, bool dispatch);
 void	print_focus(const char*, Client*, const char*);
@@ -139,7 +149,6 @@ void	ewmh_getwintype(Client*);
 void	ewmh_init(void);
 void	ewmh_initclient(Client*);
 void	ewmh_pingclient(Client*);
-int	ewmh_prop(Client*, Atom);
 long	ewmh_protocols(Window*);
 void	ewmh_updateclient(Client*);
 void	ewmh_updateclientlist(void);
@@ -152,17 +161,21 @@ void	ewmh_updateviews(void);
 /* float.c */
 void	float_arrange(Area*);
 void	float_attach(Area*, Frame*);
+void	float_destroy(Area*);
 void	float_detach(Frame*);
 void	float_resizeframe(Frame*, Rectangle);
+void	float_sync(Area*);
 Vector_rect*	unique_rects(Vector_rect*, Rectangle);
 Rectangle	max_rect(Vector_rect*);
 
 /* frame.c */
 Frame*	frame_create(Client*, View*);
+void	frame_damage_all(void);
 int	frame_delta_h(void);
 void	frame_draw(Frame*);
 void	frame_draw_all(void);
 void	frame_focus(Frame*);
+void	frame_freebacking(Client*);
 uint	frame_idx(Frame*);
 void	frame_insert(Frame*, Frame *pos);
 void	frame_remove(Frame*);
@@ -200,6 +213,10 @@ bool	rect_haspoint_p(Point, Rectangle);
 bool	rect_intersect_p(Rectangle, Rectangle);
 Rectangle	rect_intersection(Rectangle, Rectangle);
 
+/* ibuf.c */
+Image*	ibuf_get(int w, int h, int depth);
+void	ibuf_put(Image*);
+
 /* key.c */
 void	init_lock_keys(void);
 void	kpress(XWindow, ulong mod, KeyCode);
@@ -246,9 +263,13 @@ void	mouse_checkresize(Frame*, Point, bool);
 void	mouse_movegrabbox(Client*, bool);
 void	mouse_resize(Client*, Align, bool);
 void	mouse_resizecol(Divide*);
+int	readdrag(Point*, uint*);
 bool	readmotion(Point*);
 int	readmouse(Point*, uint*);
-Align	snap_rect(const Rectangle *rects, int num, Rectangle *current, Align *mask, int snapw);
+Align	snap_rect(View*, Frame *ignore, Rectangle *current, Align *mask, int snapw);
+
+/* prefetch.c */
+void	prefetch_windows(XWindow*, int, XWindowAttributes*);
 
 /* print.c */
 int	Ffmt(Fmt*);
@@ -264,15 +285,41 @@ void*	findthing(Rectangle, int, Vector_ptr*, Rectangle(*)(void*), bool);
 int	ownerscreen(Rectangle);
 
 /* rule.c */
+Rule*	rule_match(Ruleset*, char*);
 void	trim(char *str, const char *chars);
-void	update_rules(Rule**, const char*);
+void	update_rules(Ruleset*, const char*);
+
+/* state.c */
+bool	state_attach(View*, Frame*);
+void	state_finish(void);
+void	state_load(char*);
+bool	state_save(char*);
+
+/* stats.c */
+void	stats_9pin(Fcall*);
+void	stats_9pout(Ixp9Req*);
+void	stats_add(Histogram*, ulong);
+char*	stats_render(void);
+uvlong	stats_time(void);
+
+/* trace.c */
+uvlong	trace_begin(void);
+void	trace_end(char*, char*, uvlong);
+char*	trace_render(void);
+void	trace_start(void);
+void	trace_stop(void);
 
 /* view.c */
 void	view_arrange(View*);
 void	view_attach(View*, Frame*);
+void	view_batcharrange(void);
+bool	view_batching(void);
+void	view_beginbatch(void);
 View*	view_create(const char*);
 void	view_destroy(View*);
 void	view_detach(Frame*);
+void	view_endbatch(void);
+View*	view_find(const char*);
 Area*	view_findarea(View*, int, int, bool);
 void	view_focus(WMScreen*, View*);
 bool	view_fullscreen_p(View*, int);
@@ -287,7 +334,6 @@ void	view_select(const char*);
 void	view_update(View*);
 void	view_update_all(void);
 void	view_update_rect(View*);
-Rectangle*	view_rects(View*, uint *num, Frame *ignore);
 
 /* _util.c */
 void	backtrace(char*);
@@ -315,6 +361,7 @@ void	xdnd_initwindow(Window*);
 
 /* xext.c */
 void	randr_event(XEvent*);
+int	randr_refresh(void);
 bool	render_argb_p(Visual*);
 void	xext_event(XEvent*);
 void	xext_init(void);
@@ -152,6 +152,7 @@ static void
 bdown_event(Window *w, XButtonEvent *e) {
 	Frame *f;
 	Client *c;
+	bool inclient;
 
 	c = w->aux;
 	f = c->sel;
@@ -177,8 +178,10 @@ bdown_event(Window *w, XButtonEvent *e) {
 			break;
 		}
 	}else {
+		/* The titlebar may be a window of its own. */
+		inclient = e->subwindow == c->w.xid;
 		if(e->button == Button1) {
-			if(!e->subwindow) {
+			if(!inclient) {
 				frame_restack(f, nil);
 				view_restack(f->view);
 				mouse_checkresize(f, Pt(e->x, e->y), true);
@@ -187,7 +190,7 @@ bdown_event(Window *w, XButtonEvent *e) {
 			if(f->client != selclient())
 				focus(c, false);
 		}
-		if(e->subwindow)
+		if(inclient)
 			XAllowEvents(display, ReplayPointer, e->time);
 		else {
 			/* Ungrab so a menu can receive events before the button is released */
@@ -231,6 +234,10 @@ expose_event(Window *w, XExposeEvent *e) {
 	USED(e);
 
 	c = w->aux;
+	/* The server repaints from the backing pixmap itself. */
+	if(c->backing && def.framebacking)
+		return;
+	c->deco.valid = false;
 	if(c->sel)
 		frame_draw(c->sel);
 	else
@@ -420,24 +427,158 @@ pushlabel(Image *img, Rectangle *rp, char *s, CTuple *col) {
 	}
 }
 
+enum {
+	DNone,
+	DTitle,
+	DAll,
+};
+
+static void
+frame_getdecoration(Frame *f, CTuple *col, Decoration *d) {
+	Client *c;
+	int n, m;
+
+	c = f->client;
+	d->r = rectsetorigin(c->framewin->r, ZP);
+	d->crect = f->crect;
+	memcpy(d->colstr, col->colstr, sizeof d->colstr);
+	utflcpy(d->label, c->name, sizeof d->label);
+	d->count[0] = '\0';
+	if(f->area->max && !resizing) {
+		/* XXX */
+		n = stack_count(f, &m);
+		snprint(d->count, sizeof d->count, "%d/%d", m, n);
+	}
+	d->tags = client_extratags(c);
+	d->focus = (c == selclient()) | (c == disp.focus) << 1;
+	d->border = f->area->floating && c->borderless && c->titleless
+		 && !c->fullscreen && c == selclient();
+	d->floating = f->area->floating;
+	d->room = c->floating;
+	d->urgent = c->urgent;
+	d->valid = true;
+}
+
+/* Returns how much of the frame must be redrawn to go from o to n. */
+static int
+decoration_damage(Decoration *o, Decoration *n) {
+
+	if(!o->valid
+	|| !eqrect(o->r, n->r)
+	|| !eqrect(o->crect, n->crect)
+	|| memcmp(o->colstr, n->colstr, sizeof o->colstr)
+	|| o->border != n->border)
+		return DAll;
+	if(strcmp(o->label, n->label)
+	|| strcmp(o->count, n->count)
+	|| strcmp(o->tags ? o->tags : "", n->tags ? n->tags : "")
+	|| o->focus != n->focus
+	|| o->floating != n->floating
+	|| o->room != n->room
+	|| o->urgent != n->urgent)
+		return DTitle;
+	return DNone;
+}
+
+/* Copies the parts of the frame not covered by the client window. */
+static void
+copydecoration(Frame *f, Image *img, Rectangle fr) {
+	Window *w;
+	Rectangle cr, r[4];
+	int i;
+
+	w = f->client->framewin;
+	cr = f->crect;
+	if(f->collapsed || !f->client->w.mapped || !rect_contains_p(fr, cr)) {
+		copyimage(w, fr, img, ZP);
+		return;
+	}
+
+	r[0] = Rect(0, 0, fr.max.x, cr.min.y);
+	r[1] = Rect(0, cr.max.y, fr.max.x, fr.max.y);
+	r[2] = Rect(0, cr.min.y, cr.min.x, cr.max.y);
+	r[3] = Rect(cr.max.x, cr.min.y, fr.max.x, cr.max.y);
+	for(i=0; i < nelem(r); i++)
+		if(Dx(r[i]) > 0 && Dy(r[i]) > 0)
+			copyimage(w, r[i], img, r[i].min);
+}
+
+/* Returns the pixmap c's titlebar is kept in, when framebacking
+ * is on, or nil. The titlebar gets a window of its own, with the
+ * pixmap as its background, and the rest of the frame shows the
+ * frame's background colour. The pixmap is only reallocated when
+ * the titlebar outgrows it or shrinks to under half its width, so
+ * dragging a frame's edge seldom touches it.
+ */
+static Image*
+frame_backing(Client *c, Rectangle r) {
+	WinAttr wa;
+	int depth, w;
+
+	if(!def.framebacking || Dx(r) <= 0 || Dy(r) <= 0)
+		return nil;
+	depth = c->framewin->depth;
+	if(c->titlewin == nil) {
+		/* It selects no input, so the frame gets its pointer events. */
+		wa.background_pixmap = None;
+		c->titlewin = createwindow_visual(c->framewin, r, depth,
+				c->framewin->visual, InputOutput,
+				&wa, CWBackPixmap);
+		/* Titleless clients cover it. */
+		XLowerWindow(display, c->titlewin->xid);
+		mapwin(c->titlewin);
+	}
+	reshapewin(c->titlewin, r);
+
+	w = c->backing ? Dx(c->backing->r) : 0;
+	if(c->backing && c->backing->depth == depth && Dy(c->backing->r) == Dy(r)
+	&& w >= Dx(r) && w <= 2 * Dx(r))
+		return c->backing;
+	freeimage(c->backing);
+	c->backing = allocimage(Dx(r) + Dx(r) / 4, Dy(r), depth);
+	c->deco.valid = false;
+	return c->backing;
+}
+
+void
+frame_freebacking(Client *c) {
+
+	if(c->backing == nil)
+		return;
+	XSetWindowBackgroundPixmap(display, c->framewin->xid, None);
+	destroywindow(c->titlewin);
+	c->titlewin = nil;
+	freeimage(c->backing);
+	c->backing = nil;
+}
+
+void
+frame_damage_all(void) {
+	Client *c;
+
+	for(c=client; c; c=c->next)
+		c->deco.valid = false;
+}
+
 void
 frame_draw(Frame *f) {
-	Rectangle r, fr;
+	Decoration d;
+	Rectangle r, fr, tr;
 	Client *c;
 	CTuple *col;
 	Image *img;
-	char *s;
+	uvlong t;
 	uint w;
-	int n, m;
+	int damage;
 
+	stats.frame_draw++;
 	if(f->view != selview)
 		return;
 	if(f->area == nil) /* Blech. */
 		return;
 
 	c = f->client;
-	img = *c->ibuf;
-	fr = rectsetorigin(c->framewin->r, ZP);
+	img = frame_backing(c, Rect(0, 0, Dx(c->framewin->r), labelh(def.font)));
 
 	/* Pick colors. */
 	if(c == selclient() || c == disp.focus)
@@ -445,31 +586,48 @@ frame_draw(Frame *f) {
 	else
 		col = &def.normcolor;
 
-	/* Background/border */
-	r = fr;
-	fill(img, r, col->bg);
-	border(img, r, 1, col->border);
+	/* Compare against what's already on screen, and only redraw
+	 * what's changed.
+	 */
+	frame_getdecoration(f, col, &d);
+	damage = decoration_damage(&c->deco, &d);
+	free(c->deco.tags);
+	c->deco = d;
 
-	/* Title border */
-	r.max.y = r.min.y + labelh(def.font);
-	border(img, r, 1, col->border);
+	fr = d.r;
+	tr = fr;
+	tr.max.y = tr.min.y + labelh(def.font);
 
-	f->titlebar = insetrect(r, 3);
+	f->titlebar = insetrect(tr, 3);
 	f->titlebar.max.y += 3;
 
+	f->grabbox = tr;
+	f->grabbox.min = Pt(2, 2);
+	f->grabbox.max.y -= 2;
+	f->grabbox.max.x = f->grabbox.min.x + Dy(f->grabbox);
+
+	if(damage == DNone)
+		return;
+
+	t = trace_begin();
+	if(img == nil)
+		img = ibuf_get(Dx(fr), Dy(fr), c->framewin->depth);
+	/* Background/border */
+	fill(img, damage == DTitle ? tr : fr, col->bg);
+	border(img, fr, 1, col->border);
+
+	/* Title border */
+	border(img, tr, 1, col->border);
+
 	/* Odd focus. Unselected, with keyboard focus. */
 	/* Draw a border just inside the titlebar. */
 	if(c != selclient() && c == disp.focus) {
-		border(img, insetrect(r, 1), 1, def.normcolor.bg);
-		border(img, insetrect(r, 2), 1, def.focuscolor.border);
+		border(img, insetrect(tr, 1), 1, def.normcolor.bg);
+		border(img, insetrect(tr, 2), 1, def.focuscolor.border);
 	}
 
 	/* grabbox */
-	r.min = Pt(2, 2);
-	r.max.y -= 2;
-	r.max.x = r.min.x + Dy(r);
-	f->grabbox = r;
-
+	r = f->grabbox;
 	if(c->urgent)
 		fill(img, r, col->fg);
 	border(img, r, 1, col->border);
@@ -480,10 +638,12 @@ frame_draw(Frame *f) {
 		border(img, insetrect(r, -1), 1, def.normcolor.bg);
 
 	/* Draw a border on borderless+titleless selected apps. */
-	if(f->area->floating && c->borderless && c->titleless && !c->fullscreen && c == selclient())
-		setborder(c->framewin, def.border, def.focuscolor.border);
-	else
-		setborder(c->framewin, 0, def.focuscolor.border);
+	if(damage == DAll) {
+		if(d.border)
+			setborder(c->framewin, def.border, def.focuscolor.border);
+		else
+			setborder(c->framewin, 0, def.focuscolor.border);
+	}
 
 	/* Label */
 	r.min.x = r.max.x;
@@ -491,18 +651,12 @@ frame_draw(Frame *f) {
 	r.min.y = 0;
 	r.max.y = labelh(def.font);
 	/* Draw count on frames in 'max' columns. */
-	if(f->area->max && !resizing) {
-		/* XXX */
-		n = stack_count(f, &m);
-		s = smprint("%d/%d", m, n);
-		pushlabel(img, &r, s, col);
-		free(s);
-	}
+	if(d.count[0])
+		pushlabel(img, &r, d.count, col);
 	/* Label clients with extra tags. */
-	if((s = client_extratags(c))) {
-		pushlabel(img, &r, s, col);
-		free(s);
-	}else /* Make sure floating clients have room for their indicators. */
+	if(d.tags)
+		pushlabel(img, &r, d.tags, col);
+	else /* Make sure floating clients have room for their indicators. */
 	if(c->floating)
 		r.max.x -= Dx(f->grabbox);
 	w = drawstring(img, def.font, r, West,
@@ -518,11 +672,13 @@ frame_draw(Frame *f) {
 	}
 
 	/* Border increment gaps... */
-	r.min.y = f->crect.min.y;
-	r.min.x = max(1, f->crect.min.x - 1);
-	r.max.x = min(fr.max.x - 1, f->crect.max.x + 1);
-	r.max.y = min(fr.max.y - 1, f->crect.max.y + 1);
-	border(img, r, 1, col->border);
+	if(damage == DAll) {
+		r.min.y = f->crect.min.y;
+		r.min.x = max(1, f->crect.min.x - 1);
+		r.max.x = min(fr.max.x - 1, f->crect.max.x + 1);
+		r.max.y = min(fr.max.y - 1, f->crect.max.y + 1);
+		border(img, r, 1, col->border);
+	}
 
 	/* Why? Because some non-ICCCM-compliant apps feel the need to
 	 * change the background properties of all of their ancestor windows
@@ -530,9 +686,25 @@ frame_draw(Frame *f) {
 	 * What's more, the designers of X11 felt that it would be unfair to
 	 * implementers to make it possible to detect, or forbid, such changes.
 	 */
-	XSetWindowBackgroundPixmap(display, c->framewin->xid, None);
-
-	copyimage(c->framewin, fr, img, ZP);
+	if(img == c->backing) {
+		/* The same goes for the backing pixmap, so it's set anew
+		 * on every draw. Only the titlebar is kept in it. Around
+		 * the client, the frame is the border colour.
+		 */
+		XSetWindowBackground(display, c->framewin->xid, col->border.pixel);
+		XSetWindowBackgroundPixmap(display, c->titlewin->xid, img->xid);
+		if(damage == DAll)
+			XClearWindow(display, c->framewin->xid);
+		XClearWindow(display, c->titlewin->xid);
+	}else {
+		XSetWindowBackgroundPixmap(display, c->framewin->xid, None);
+		if(damage == DTitle)
+			copyimage(c->framewin, tr, img, tr.min);
+		else
+			copydecoration(f, img, fr);
+		ibuf_put(img);
+	}
+	trace_end("draw", "frame_draw", t);
 }
 
 void
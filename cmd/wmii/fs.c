@@ -22,9 +22,44 @@ union IxpFileIdU {
 
 #include <ixp_srvutil.h>
 
-static IxpPending	events;
+/* Responses pass through here, to be timed for /debug/stats. */
+#undef respond
+static void
+respond(Ixp9Req *r, const char *err) {
+	stats_9pout(r);
+	ixp_respond(r, err);
+}
+
 static IxpPending	pdebug[NDebugOpt];
 
+/* Each fid which has /event open for reading has its own queue and,
+ * optionally, a list of patterns (set by writing "filter <pattern>
+ * ..." to the fid) which the event name must match for the event to
+ * be queued.
+ */
+typedef struct Listener Listener;
+struct Listener {
+	Listener*	next;
+	Fid*		fid;
+	IxpPending	pending;
+	char**		filter;
+};
+
+static Listener*	listeners;
+
+/* Generated files are rendered once, when they're opened for
+ * reading, and reads are served from that copy. The snapshots are
+ * indexed by fid.
+ */
+typedef struct Snapshot Snapshot;
+struct Snapshot {
+	char*	data;
+	uint	size;
+};
+
+static MapEnt*	sbucket[137];
+static Map	snapmap = { sbucket, nelem(sbucket) };
+
 /* Constants */
 enum {	/* Dirs */
 	FsDBars,
@@ -44,9 +79,11 @@ enum {	/* Dirs */
 	FsFEvent,
 	FsFKeys,
 	FsFRctl,
+	FsFStats,
 	FsFTagRules,
 	FsFTctl,
 	FsFTindex,
+	FsFTrace,
 	FsFprops,
 };
 
@@ -102,6 +139,8 @@ dirtab_client[]= {{".",		QTDIR,		FsDClient,	0500|DMDIR },
 		  {"props",	QTFILE,		FsFprops,	0400 },
 		  {nil}},
 dirtab_debug[]=  {{".",		QTDIR,		FsDDebug,	0500|DMDIR, FLHide },
+		  {"stats",	QTFILE,		FsFStats,	0400 },
+		  {"trace",	QTFILE,		FsFTrace,	0400 },
 		  {"",		QTFILE,		FsFDebug,	0400 },
 		  {nil}},
 dirtab_bars[]=	 {{".",		QTDIR,		FsDBars,	0700|DMDIR },
@@ -125,15 +164,76 @@ static IxpDirtab* dirtab[] = {
 };
 typedef char* (*MsgFunc)(void*, IxpMsg*);
 
+/* Matches the n bytes at s against pat, in which '*' matches any
+ * run of characters.
+ */
+static bool
+eventmatch(char *pat, char *s, int n) {
+	int i;
+
+	for(; *pat; pat++, s++, n--) {
+		if(*pat == '*') {
+			for(i=0; i <= n; i++)
+				if(eventmatch(pat+1, s+i, n-i))
+					return true;
+			return false;
+		}
+		if(n == 0 || *pat != *s)
+			return false;
+	}
+	return n == 0;
+}
+
+static bool
+eventfilter(Listener *l, char *s, int n) {
+	char **p;
+
+	if(l->filter == nil)
+		return true;
+	for(p=l->filter; *p; p++)
+		if(eventmatch(*p, s, n))
+			return true;
+	return false;
+}
+
+static Listener**
+listener(Fid *f) {
+	Listener **lp;
+
+	for(lp=&listeners; *lp; lp=&lp[0]->next)
+		if(lp[0]->fid == f)
+			break;
+	return lp;
+}
+
+static void
+setfilter(Listener *l, char *s) {
+	char *toks[32];
+	int n;
+
+	n = stokenize(toks, nelem(toks)-1, s, " \t\n");
+	toks[n] = nil;
+	free(l->filter);
+	l->filter = nil;
+	if(n > 0)
+		l->filter = strlistdup(toks);
+}
+
 void
 event(const char *format, ...) {
+	Listener *l;
 	va_list ap;
+	int n, len;
 
 	va_start(ap, format);
 	vsnprint(buffer, sizeof buffer, format, ap);
 	va_end(ap);
 
-	ixp_pending_write(&events, buffer, strlen(buffer));
+	len = strlen(buffer);
+	n = strcspn(buffer, " \n");
+	for(l=listeners; l; l=l->next)
+		if(eventfilter(l, buffer, n))
+			ixp_pending_write(&l->pending, buffer, len);
 }
 
 static int dflags;
@@ -195,6 +295,25 @@ dwrite(int flag, void *buf, int n, bool always) {
 
 static uint	fs_size(IxpFileId*);
 
+static char*
+fs_render(IxpFileId *f) {
+	switch(f->tab.type) {
+	case FsFRctl:
+		return readctl_root();
+	case FsFCctl:
+		return readctl_client(f->p.client);
+	case FsFTctl:
+		return readctl_view(f->p.view);
+	case FsFTindex:
+		return view_index(f->p.view);
+	case FsFStats:
+		return stats_render();
+	case FsFTrace:
+		return trace_render();
+	}
+	return nil;
+}
+
 static void
 dostat(Stat *s, IxpFileId *f) {
 	s->type = 0;
@@ -255,23 +374,22 @@ lookup_file(IxpFileId *parent, char *name)
 					if(name)
 						goto LastItem;
 				}
-				SET(id);
+				c = client;
 				if(name) {
 					id = (uint)strtol(name, &name, 16);
 					if(*name)
 						goto NextItem;
+					c = win2client(id);
 				}
-				for(c=client; c; c=c->next) {
-					if(!name || c->w.xid == id) {
-						push_file(sxprint("%C", c));
-						file->volatil = true;
-						file->p.client = c;
-						file->id = c->w.xid;
-						file->index = c->w.xid;
-						assert(file->tab.name);
-						if(name)
-							goto LastItem;
-					}
+				for(; c; c=c->next) {
+					push_file(sxprint("%C", c));
+					file->volatil = true;
+					file->p.client = c;
+					file->id = c->w.xid;
+					file->index = c->w.xid;
+					assert(file->tab.name);
+					if(name)
+						goto LastItem;
 				}
 				break;
 			case FsDDebug:
@@ -294,27 +412,27 @@ lookup_file(IxpFileId *parent, char *name)
 					if(name)
 						goto LastItem;
 				}
-				for(v=view; v; v=v->next) {
-					if(!name || !strcmp(name, v->name)) {
-						push_file(v->name);
-						file->volatil = true;
-						file->p.view = v;
-						file->id = v->id;
-						if(name)
-							goto LastItem;
-					}
+				v = name ? view_find(name) : view;
+				for(; v; v=v->next) {
+					push_file(v->name);
+					file->volatil = true;
+					file->p.view = v;
+					file->id = v->id;
+					if(name)
+						goto LastItem;
 				}
 				break;
 			case FsDBars:
-				for(b=*parent->p.bar_p; b; b=b->next) {
-					if(!name || !strcmp(name, b->name)) {
-						push_file(b->name);
-						file->volatil = true;
-						file->p.bar = b;
-						file->id = b->id;
-						if(name)
-							goto LastItem;
-					}
+				b = *parent->p.bar_p;
+				if(name)
+					b = bar_find(parent->p.bar_p, name);
+				for(; b; b=b->next) {
+					push_file(b->name);
+					file->volatil = true;
+					file->p.bar = b;
+					file->id = b->id;
+					if(name)
+						goto LastItem;
 				}
 				break;
 			}
@@ -421,9 +539,10 @@ fs_stat(Ixp9Req *r) {
 
 void
 fs_read(Ixp9Req *r) {
+	Snapshot *snap;
 	char *buf;
 	IxpFileId *f;
-	int n;
+	void **e;
 
 	f = r->fid->aux;
 
@@ -468,24 +587,18 @@ fs_read(Ixp9Req *r) {
 			respond(r, nil);
 			return;
 		case FsFRctl:
-			buf = readctl_root();
-			ixp_srv_readbuf(r, buf, strlen(buf));
-			respond(r, nil);
-			return;
 		case FsFCctl:
-			buf = readctl_client(f->p.client);
-			ixp_srv_readbuf(r, buf, strlen(buf));
-			respond(r, nil);
-			return;
 		case FsFTindex:
-			buf = view_index(f->p.view);
-			ixp_srv_readbuf(r, buf, strlen(buf));
-			respond(r, nil);
-			return;
 		case FsFTctl:
-			buf = readctl_view(f->p.view);
-			n = strlen(buf);
-			ixp_srv_readbuf(r, buf, n);
+			e = map_get(&snapmap, (ulong)r->fid, false);
+			if(e) {
+				snap = *e;
+				ixp_srv_readbuf(r, snap->data, snap->size);
+			}else {
+				buf = fs_render(f);
+				ixp_srv_readbuf(r, buf, strlen(buf));
+				free(buf);
+			}
 			respond(r, nil);
 			return;
 		}
@@ -498,6 +611,7 @@ void
 fs_write(Ixp9Req *r) {
 	MsgFunc mf;
 	IxpFileId *f;
+	Listener *l;
 	char *errstr;
 	char *p;
 	uint i;
@@ -557,11 +671,28 @@ fs_write(Ixp9Req *r) {
 		mf = (MsgFunc)message_root;
 		goto msg;
 	msg:
+		/* Apply every line of the write before touching the
+		 * layout, so that N commands cost one arrange, one
+		 * restack and one round of EWMH updates. Commands
+		 * which read the layout flush it first.
+		 */
+		view_beginbatch();
 		errstr = ixp_srv_writectl(r, mf);
+		view_endbatch();
 		r->ofcall.io.count = r->ifcall.io.count;
 		respond(r, errstr);
 		return;
 	case FsFEvent:
+		l = *listener(r->fid);
+		if(l && r->ifcall.io.count >= 6
+		&& !strncmp(r->ifcall.io.data, "filter", 6)
+		&& (r->ifcall.io.count == 6 || isspace((uchar)r->ifcall.io.data[6]))) {
+			ixp_srv_data2cstring(r);
+			setfilter(l, r->ifcall.io.data + 6);
+			r->ofcall.io.count = r->ifcall.io.count;
+			respond(r, nil);
+			return;
+		}
 		if(r->ifcall.io.data[r->ifcall.io.count-1] == '\n')
 			event("%.*s", (int)r->ifcall.io.count, r->ifcall.io.data);
 		else
@@ -577,7 +708,10 @@ fs_write(Ixp9Req *r) {
 
 void
 fs_open(Ixp9Req *r) {
+	Snapshot *snap;
 	IxpFileId *f;
+	Listener *l;
+	char *buf;
 	
 	f = r->fid->aux;
 
@@ -588,7 +722,13 @@ fs_open(Ixp9Req *r) {
 
 	switch(f->tab.type) {
 	case FsFEvent:
-		ixp_pending_pushfid(&events, r->fid);
+		if((r->ifcall.topen.mode&3) == OWRITE)
+			break;
+		l = emallocz(sizeof *l);
+		l->fid = r->fid;
+		l->next = listeners;
+		listeners = l;
+		ixp_pending_pushfid(&l->pending, r->fid);
 		break;
 	case FsFDebug:
 		ixp_pending_pushfid(pdebug+f->id, r->fid);
@@ -599,10 +739,18 @@ fs_open(Ixp9Req *r) {
 	if((r->ifcall.topen.mode&3) == OEXEC
 	|| (r->ifcall.topen.mode&3) != OREAD && !(f->tab.perm & 0200)
 	|| (r->ifcall.topen.mode&3) != OWRITE && !(f->tab.perm & 0400)
-	|| (r->ifcall.topen.mode & ~(3|OAPPEND|OTRUNC)))
+	|| (r->ifcall.topen.mode & ~(3|OAPPEND|OTRUNC))) {
 		respond(r, Enoperm);
-	else
-		respond(r, nil);
+		return;
+	}
+
+	if((r->ifcall.topen.mode&3) != OWRITE && (buf = fs_render(f))) {
+		snap = emalloc(sizeof *snap);
+		snap->data = buf;
+		snap->size = strlen(buf);
+		*map_get(&snapmap, (ulong)r->fid, true) = snap;
+	}
+	respond(r, nil);
 }
 
 void
@@ -654,7 +802,7 @@ fs_remove(Ixp9Req *r) {
 	case FsFBar:
 		s = f->p.bar->screen;
 		bar_destroy(f->next->p.bar_p, f->p.bar);
-		bar_draw(s);
+		bar_damage(s);
 		respond(r, nil);
 		break;
 	}
@@ -681,10 +829,8 @@ fs_clunk(Ixp9Req *r) {
 
 	switch(f->tab.type) {
 	case FsFColRules:
-		update_rules(&f->p.rule->rule, f->p.rule->string);
-		break;
 	case FsFTagRules:
-		update_rules(&f->p.rule->rule, f->p.rule->string);
+		update_rules(f->p.rule, f->p.rule->string);
 		/*
 		for(c=client; c; c=c->next)
 			apply_rules(c);
@@ -715,6 +861,20 @@ fs_flush(Ixp9Req *r) {
 void
 fs_freefid(Fid *f) {
 	IxpFileId *id, *tid;
+	Listener **lp, *l;
+	Snapshot *snap;
+
+	if((snap = map_rm(&snapmap, (ulong)f))) {
+		free(snap->data);
+		free(snap);
+	}
+
+	lp = listener(f);
+	if((l = *lp)) {
+		*lp = l->next;
+		free(l->filter);
+		free(l);
+	}
 
 	tid = f->aux;
 	while((id = tid)) {
@@ -0,0 +1,135 @@
+/* Copyright ©2009 Kris Maglione <maglione.k at Gmail>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include "fns.h"
+
+/* Scratch pixmaps, which frames, bars and the like are drawn into
+ * before being copied to their windows. Rather than keep one the
+ * size of the whole display for each depth, a few are kept, rounded
+ * up to IbufGrain in each dimension so that nearby sizes share them.
+ * They're allocated as they're needed, and freed once they've gone
+ * unused for IbufIdle milliseconds.
+ */
+
+enum {
+	NIbuf		= 8,
+	IbufGrain	= 64,
+	IbufIdle	= 5000,
+};
+
+typedef struct Ibuf Ibuf;
+struct Ibuf {
+	Image*	img;
+	uvlong	used;
+	bool	busy;
+};
+
+static Ibuf	pool[NIbuf];
+static long	timer;
+
+static ulong
+footprint(Image *img) {
+	int bpp;
+
+	bpp = img->depth > 16 ? 4 : img->depth > 8 ? 2 : 1;
+	return Dx(img->r) * Dy(img->r) * bpp;
+}
+
+static void
+release(Ibuf *b) {
+	stats.ibuf_count--;
+	stats.ibuf_bytes -= footprint(b->img);
+	freeimage(b->img);
+	b->img = nil;
+}
+
+static void
+trimpool(long id, void *aux) {
+	uvlong now;
+	int i, n;
+
+	USED(id, aux);
+	timer = 0;
+	now = stats_time();
+	n = 0;
+	for(i=0; i < NIbuf; i++)
+		if(pool[i].img && !pool[i].busy) {
+			if(now - pool[i].used >= IbufIdle * 1000)
+				release(&pool[i]);
+			else
+				n++;
+		}
+	if(n)
+		timer = ixp_settimer(&srv, IbufIdle, trimpool, nil);
+}
+
+/* Returns a pixmap at least w×h, of the given depth, to be handed
+ * back with ibuf_put once it's been copied from.
+ */
+Image*
+ibuf_get(int w, int h, int depth) {
+	Ibuf *b, *best;
+	int i;
+
+	w = max(w, 1);
+	h = max(h, 1);
+	best = nil;
+	for(i=0; i < NIbuf; i++) {
+		b = &pool[i];
+		if(b->img == nil || b->busy || b->img->depth != depth)
+			continue;
+		if(Dx(b->img->r) < w || Dy(b->img->r) < h)
+			continue;
+		if(best == nil || footprint(b->img) < footprint(best->img))
+			best = b;
+	}
+	if(best) {
+		stats.ibuf_hit++;
+		best->busy = true;
+		return best->img;
+	}
+
+	/* Take an empty slot, or else the one least recently used. */
+	for(i=0; i < NIbuf; i++) {
+		b = &pool[i];
+		if(b->busy)
+			continue;
+		if(b->img == nil) {
+			best = b;
+			break;
+		}
+		if(best == nil || b->used < best->used)
+			best = b;
+	}
+
+	w = (w + IbufGrain - 1) / IbufGrain * IbufGrain;
+	h = (h + IbufGrain - 1) / IbufGrain * IbufGrain;
+	stats.ibuf_alloc++;
+	if(best == nil) {
+		/* Badness. Every slot is in use. ibuf_put frees this. */
+		return allocimage(w, h, depth);
+	}
+	if(best->img)
+		release(best);
+	best->img = allocimage(w, h, depth);
+	best->busy = true;
+	stats.ibuf_count++;
+	stats.ibuf_bytes += footprint(best->img);
+	return best->img;
+}
+
+void
+ibuf_put(Image *img) {
+	int i;
+
+	for(i=0; i < NIbuf; i++)
+		if(pool[i].img == img) {
+			pool[i].busy = false;
+			pool[i].used = stats_time();
+			if(timer == 0)
+				timer = ixp_settimer(&srv, IbufIdle, trimpool, nil);
+			return;
+		}
+	freeimage(img);
+}
@@ -109,15 +109,16 @@ expose_event(Window *w, XExposeEvent *e) {
 
 	f = w->aux;
 	c = &def.focuscolor;
-	buf = disp.ibuf;
 	
 	r = rectsubpt(w->r, w->r.min);
+	buf = ibuf_get(Dx(r), Dy(r), w->depth);
 	fill(buf, r, c->bg);
 	border(buf, r, 1, c->border);
 	border(buf, f->grabbox, 1, c->border);
 	border(buf, insetrect(f->grabbox, -f->grabbox.min.x), 1, c->border);
 
 	copyimage(w, r, buf, ZP);	
+	ibuf_put(buf);
 }
 
 static Handlers handlers = {
@@ -401,14 +402,55 @@ column_drop(Area *a, Frame *f, int y) {
 	column_insert(a, f, ff);
 }
 
+/* Moves f to the column and position picked out by fw. */
+static void
+thcol_drop(Frame *f, Framewin *fw) {
+	Frame *fp, *fn;
+	Area *a;
+	int collapsed;
+
+	SET(collapsed);
+	SET(fp);
+	SET(fn);
+	a = f->area;
+	if(a->floating)
+		area_detach(f);
+	else {
+		collapsed = f->collapsed;
+		fp = f->aprev;
+		fn = f->anext;
+		column_remove(f);
+		if(!f->collapsed)
+			if(fp)
+				fp->colr.max.y = f->colr.max.y;
+			else if(fn && fw->pt.y > fn->r.min.y)
+				fn->colr.min.y = f->colr.min.y;
+	}
+
+	column_drop(fw->ra, f, fw->pt.y);
+	if(!a->floating && collapsed) {
+		/* XXX */
+		for(; fn && fn->collapsed; fn=fn->anext)
+			;
+		if(fn == nil)
+			for(fn=fp; fn && fn->collapsed; fn=fn->aprev)
+				;
+		if(fp)
+			fp->colr.max.x += labelh(def.font);
+	}
+
+
+	if(!a->frame && !a->floating && a->view->areas[a->screen]->next)
+		area_destroy(a);
+}
+
 static int
 thcol(Frame *f) {
 	Framewin *fw;
-	Frame *fp, *fn;
-	Area *a;
+	Area *ra;
 	Point pt, pt2;
 	uint button;
-	int ret, collapsed;
+	int ret, y;
 
 	focus(f->client, false);
 
@@ -422,48 +464,27 @@ thcol(Frame *f) {
 	fw = framewin(f, pt2, OHoriz, Dx(f->area->r));
 
 	vplace(fw, pt);
+	ra = nil;
+	y = 0;
 	for(;;)
-		switch (readmouse(&pt, &button)) {
+		switch (readdrag(&pt, &button)) {
 		case MotionNotify:
 			vplace(fw, pt);
+			/* With opaquemove, the frame follows the pointer
+			 * rather than waiting for the button to be released.
+			 */
+			if(def.opaquemove && !f->area->floating && fw->ra
+			&& (fw->ra != ra || fw->pt.y != y)) {
+				ra = fw->ra;
+				y = fw->pt.y;
+				thcol_drop(f, fw);
+				view_update(f->view);
+			}
 			break;
 		case ButtonRelease:
 			if(button != 1)
 				continue;
-			SET(collapsed);
-			SET(fp);
-			SET(fn);
-			a = f->area;
-			if(a->floating)
-				area_detach(f);
-			else {
-				collapsed = f->collapsed;
-				fp = f->aprev;
-				fn = f->anext;
-				column_remove(f);
-				if(!f->collapsed)
-					if(fp)
-						fp->colr.max.y = f->colr.max.y;
-					else if(fn && fw->pt.y > fn->r.min.y)
-						fn->colr.min.y = f->colr.min.y;
-			}
-
-			column_drop(fw->ra, f, fw->pt.y);
-			if(!a->floating && collapsed) {
-				/* XXX */
-				for(; fn && fn->collapsed; fn=fn->anext)
-					;
-				if(fn == nil)
-					for(fn=fp; fn && fn->collapsed; fn=fn->aprev)
-						;
-				if(fp)
-					fp->colr.max.x += labelh(def.font);
-			}
-
-
- 			if(!a->frame && !a->floating && a->view->areas[a->screen]->next)
- 				area_destroy(a);
-
+			thcol_drop(f, fw);
 			frame_focus(f);
 			goto done;
 		case ButtonPress:
@@ -541,12 +562,11 @@ done:
 
 static int
 tfloat(Frame *f) {
-	Rectangle *rects;
 	Rectangle frect, origin;
 	Point pt, pt1;
 	Client *c;
 	Align align;
-	uint nrect, button;
+	uint button;
 	int ret;
 
 	c = f->client;
@@ -564,7 +584,7 @@ tfloat(Frame *f) {
 	if(!grabpointer(c->framewin, nil, cursor[CurMove], MouseMask))
 		return TDone;
 
-	rects = view_rects(f->view, &nrect, f);
+	float_sync(f->area);
 	origin = f->r;
 	frect = f->r;
 
@@ -575,7 +595,7 @@ tfloat(Frame *f) {
 
 shut_up_ken:
 	for(;;pt1=pt)
-		switch (readmouse(&pt, &button)) {
+		switch (readdrag(&pt, &button)) {
 		default: goto shut_up_ken;
 		case MotionNotify:
 		case_motion:
@@ -584,7 +604,7 @@ shut_up_ken:
 			frect = origin;
 
 			align = Center;
-			snap_rect(rects, nrect, &frect, &align, def.snap);
+			snap_rect(f->view, f, &frect, &align, def.snap);
 
 			frect = frame_hints(f, frect, Center);
 			frect = constrain(frect, -1);
@@ -602,7 +622,6 @@ shut_up_ken:
 			goto done;
 		}
 done:
-	free(rects);
 	return ret;
 }
 
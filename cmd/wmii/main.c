@@ -20,6 +20,7 @@ static const char
 
 static char*	address;
 static char*	ns_path;
+static char*	statefile;
 static int	sleeperfd;
 static int	sock;
 static int	exitsignal;
@@ -37,35 +38,56 @@ errfmt(Fmt *f) {
 	return fmtstrcpy(f, ixp_errbuf());
 }
 
+static bool
+transient_p(XWindow xid) {
+	Window w;
+	long *l;
+	int n;
+
+	w.type = WWindow;
+	w.xid = xid;
+	n = getprop_long(&w, "WM_TRANSIENT_FOR", "WINDOW", 0L, &l, 1L);
+	free(l);
+	return n > 0;
+}
+
 static void
 scan_wins(void) {
 	int i;
 	uint num;
 	XWindow *wins;
-	XWindowAttributes wa;
+	XWindowAttributes *wa;
 	XWindow d1, d2;
 
+	if(statefile)
+		state_load(statefile);
+
 	if(XQueryTree(display, scr.root.xid, &d1, &d2, &wins, &num)) {
+		/* Fetch everything client_create needs in one round trip. */
+		wa = emalloc(num * sizeof *wa);
+		prefetch_windows(wins, num, wa);
 		for(i = 0; i < num; i++) {
-			if(!XGetWindowAttributes(display, wins[i], &wa))
+			if(wa[i].root == None)
 				continue;
 			/* Skip transients. */
-			if(wa.override_redirect || XGetTransientForHint(display, wins[i], &d1))
+			if(wa[i].override_redirect || transient_p(wins[i]))
 				continue;
-			if(wa.map_state == IsViewable)
-				client_create(wins[i], &wa);
+			if(wa[i].map_state == IsViewable)
+				client_create(wins[i], &wa[i]);
 		}
 		/* Manage transients. */
 		for(i = 0; i < num; i++) {
-			if(!XGetWindowAttributes(display, wins[i], &wa))
+			if(wa[i].root == None)
 				continue;
-			if((XGetTransientForHint(display, wins[i], &d1))
-			&& (wa.map_state == IsViewable))
-				client_create(wins[i], &wa);
+			if(transient_p(wins[i]) && (wa[i].map_state == IsViewable))
+				client_create(wins[i], &wa[i]);
 		}
+		propcache_flush();
+		free(wa);
 	}
 	if(wins)
 		XFree(wins);
+	state_finish();
 }
 
 static void
@@ -95,6 +117,11 @@ init_environment(void) {
 		setenv("WMII_ADDRESS", address, true);
 	else
 		address = smprint("unix!%s/wmii", ns_path);
+	/* Left by our predecessor, for scan_wins. */
+	if((statefile = getenv("WMII_STATE"))) {
+		statefile = estrdup(statefile);
+		unsetenv("WMII_STATE");
+	}
 	setenv("WMII_CONFPATH", sxprint("%s/.wmii%s:%s/wmii%s",
 					getenv("HOME"), CONFVERSION,
 					CONFPREFIX, CONFVERSION), true);
@@ -195,16 +222,6 @@ init_screens(void) {
 
 	nscreens = m;
 
-	/* Reallocate buffers. */
-	freeimage(ibuf);
-	freeimage(ibuf32);
-	ibuf = allocimage(Dx(scr.rect), Dy(scr.rect), scr.depth);
-	ibuf32 = nil; /* Probably shouldn't do this until it's needed. */
-	if(render_visual)
-		ibuf32 = allocimage(Dx(scr.rect), Dy(scr.rect), 32);
-	disp.ibuf = ibuf;
-	disp.ibuf32 = ibuf32;
-
 	/* Resize and initialize screens. */
 	for(i=0; i < nscreens; i++) {
 		screen = screens[i];
@@ -323,6 +340,8 @@ check_preselect(IxpServer *s) {
 	USED(s);
 
 	check_x_event(nil);
+	bar_flush();
+	XFlush(display);
 }
 
 static void
@@ -334,6 +353,9 @@ closedisplay(IxpConn *c) {
 
 static void
 printfcall(IxpFcall *f) {
+	/* T-messages have even types. */
+	if((f->hdr.type & 1) == 0)
+		stats_9pin(f);
 	Dprint(D9p, "%F\n", f);
 }
 
@@ -449,6 +471,12 @@ extern int fmtevent(Fmt*);
 	else
 		event("Quit");
 
+	if(execstr) {
+		s = smprint("%s/state", ns_path);
+		if(state_save(s))
+			setenv("WMII_STATE", s, true);
+		free(s);
+	}
 	cleanup();
 
 	if(exitsignal)
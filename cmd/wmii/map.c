@@ -69,9 +69,12 @@ hash_getp(Map *map, const char *str, int create) {
 		for(; *e; e = &(*e)->next)
 			if((*e)->hash > h || (cmp = strcmp((*e)->key, str)) >= 0)
 				break;
-		if(*e == nil || (*e)->hash > h || cmp > 0)
+		if(*e == nil || (*e)->hash > h || cmp > 0) {
 			if(create)
 				insert(e, h, str);
+			else
+				e = &NM;
+		}
 	}
 	return e;
 }
@@ -36,6 +36,7 @@ enum {
 	LFOCUSCOLORS,
 	LFONT,
 	LFONTPAD,
+	LFRAMEBACKING,
 	LGRABMOD,
 	LGROW,
 	LINCMODE,
@@ -45,6 +46,7 @@ enum {
 	LNUDGE,
 	LOFF,
 	LON,
+	LOPAQUEMOVE,
 	LQUIT,
 	LRIGHT,
 	LSELCOLORS,
@@ -71,6 +73,7 @@ char *symtab[] = {
 	"focuscolors",
 	"font",
 	"fontpad",
+	"framebacking",
 	"grabmod",
 	"grow",
 	"incmode",
@@ -80,6 +83,7 @@ char *symtab[] = {
 	"nudge",
 	"off",
 	"on",
+	"opaquemove",
 	"quit",
 	"right",
 	"selcolors",
@@ -428,14 +432,16 @@ getframe(View *v, int scrn, IxpMsg *m) {
 
 char*
 readctl_client(Client *c) {
-	bufclear();
-	bufprint("%C\n", c);
+	Fmt f;
+
+	fmtstrinit(&f);
+	fmtprint(&f, "%C\n", c);
 	if(c->fullscreen >= 0)
-		bufprint("Fullscreen %d\n", c->fullscreen);
+		fmtprint(&f, "Fullscreen %d\n", c->fullscreen);
 	else
-		bufprint("Fullscreen off\n");
-	bufprint("Urgent %s\n", toggletab[(int)c->urgent]);
-	return buffer;
+		fmtprint(&f, "Fullscreen off\n");
+	fmtprint(&f, "Urgent %s\n", toggletab[(int)c->urgent]);
+	return fmtstrflush(&f);
 }
 
 char*
@@ -489,6 +495,7 @@ message_client(Client *c, IxpMsg *m) {
 
 char*
 message_root(void *p, IxpMsg *m) {
+	Client *c;
 	Font *fn;
 	char *s, *ret;
 	ulong n;
@@ -518,6 +525,7 @@ message_root(void *p, IxpMsg *m) {
 		if(!getulong(msg_getword(m), &n))
 			return Ebadvalue;
 		def.border = n;
+		frame_damage_all();
 		view_update(selview);
 		break;
 	case LCOLMODE:
@@ -537,6 +545,7 @@ message_root(void *p, IxpMsg *m) {
 		break;
 	case LFOCUSCOLORS:
 		ret = msg_parsecolors(m, &def.focuscolor);
+		frame_damage_all();
 		view_update(selview);
 		break;
 	case LFONT:
@@ -548,6 +557,7 @@ message_root(void *p, IxpMsg *m) {
 				bar_resize(screens[n]);
 		}else
 			ret = "can't load font";
+		frame_damage_all();
 		view_update(selview);
 		break;
 	case LFONTPAD:
@@ -559,9 +569,23 @@ message_root(void *p, IxpMsg *m) {
 		else {
 			for(n=0; n < nscreens; n++)
 				bar_resize(screens[n]);
+			frame_damage_all();
 			view_update(selview);
 		}
 		break;
+	case LFRAMEBACKING:
+		i = gettoggle(msg_getword(m));
+		if(i == -1)
+			return Ebadusage;
+		if(i == Toggle)
+			i = !def.framebacking;
+		def.framebacking = i;
+		if(!def.framebacking)
+			for(c=client; c; c=c->next)
+				frame_freebacking(c);
+		frame_damage_all();
+		view_update(selview);
+		break;
 	case LGRABMOD:
 		s = msg_getword(m);
 		if(!parsekey(s, &i, nil) || i == 0)
@@ -577,8 +601,17 @@ message_root(void *p, IxpMsg *m) {
 		break;
 	case LNORMCOLORS:
 		ret = msg_parsecolors(m, &def.normcolor);
+		frame_damage_all();
 		view_update(selview);
 		break;
+	case LOPAQUEMOVE:
+		i = gettoggle(msg_getword(m));
+		if(i == -1)
+			return Ebadusage;
+		if(i == Toggle)
+			i = !def.opaquemove;
+		def.opaquemove = i;
+		break;
 	case LSELCOLORS:
 		warning("selcolors have been removed");
 		return Ebadcmd;
@@ -595,41 +628,45 @@ message_root(void *p, IxpMsg *m) {
 }
 
 static void
-printdebug(int mask) {
+printdebug(Fmt *f, int mask) {
 	int i, j;
 
 	for(i=0, j=0; i < nelem(debugtab); i++)
 		if(mask & (1<<i)) {
-			if(j++ > 0) bufprint(" ");
-			bufprint("%s", debugtab[i]);
+			if(j++ > 0) fmtprint(f, " ");
+			fmtprint(f, "%s", debugtab[i]);
 		}
 }
 
 char*
 readctl_root(void) {
-	bufclear();
-	bufprint("bar on %s\n", barpostab[screen->barpos]);
-	bufprint("border %d\n", def.border);
-	bufprint("colmode %s\n", modes[def.colmode]);
+	Fmt f;
+
+	fmtstrinit(&f);
+	fmtprint(&f, "bar on %s\n", barpostab[screen->barpos]);
+	fmtprint(&f, "border %d\n", def.border);
+	fmtprint(&f, "colmode %s\n", modes[def.colmode]);
 	if(debugflag) {
-		bufprint("debug ");
-		printdebug(debugflag);
-		bufprint("\n");
+		fmtprint(&f, "debug ");
+		printdebug(&f, debugflag);
+		fmtprint(&f, "\n");
 	}
 	if(debugfile) {
-		bufprint("debugfile ");
-		printdebug(debugfile);
-		bufprint("\n");
+		fmtprint(&f, "debugfile ");
+		printdebug(&f, debugfile);
+		fmtprint(&f, "\n");
 	}
-	bufprint("focuscolors %s\n", def.focuscolor.colstr);
-	bufprint("font %s\n", def.font->name);
-	bufprint("fontpad %d %d %d %d\n", def.font->pad.min.x, def.font->pad.max.x,
+	fmtprint(&f, "focuscolors %s\n", def.focuscolor.colstr);
+	fmtprint(&f, "font %s\n", def.font->name);
+	fmtprint(&f, "fontpad %d %d %d %d\n", def.font->pad.min.x, def.font->pad.max.x,
 		 def.font->pad.max.y, def.font->pad.min.y);
-	bufprint("grabmod %s\n", def.grabmod);
-	bufprint("incmode %s\n", incmodetab[def.incmode]);
-	bufprint("normcolors %s\n", def.normcolor.colstr);
-	bufprint("view %s\n", selview->name);
-	return buffer;
+	fmtprint(&f, "framebacking %s\n", def.framebacking ? "on" : "off");
+	fmtprint(&f, "grabmod %s\n", def.grabmod);
+	fmtprint(&f, "incmode %s\n", incmodetab[def.incmode]);
+	fmtprint(&f, "normcolors %s\n", def.normcolor.colstr);
+	fmtprint(&f, "opaquemove %s\n", def.opaquemove ? "on" : "off");
+	fmtprint(&f, "view %s\n", selview->name);
+	return fmtstrflush(&f);
 }
 
 char*
@@ -716,25 +753,26 @@ message_view(View *v, IxpMsg *m) {
 
 char*
 readctl_view(View *v) {
+	Fmt f;
 	Area *a;
 	int s;
 
-	bufclear();
-	bufprint("%s\n", v->name);
+	fmtstrinit(&f);
+	fmtprint(&f, "%s\n", v->name);
 
 	/* select <area>[ <frame>] */
-	bufprint("select %a", v->sel);
+	fmtprint(&f, "select %a", v->sel);
 	if(v->sel->sel)
-		bufprint(" %d", frame_idx(v->sel->sel));
-	bufprint("\n");
+		fmtprint(&f, " %d", frame_idx(v->sel->sel));
+	fmtprint(&f, "\n");
 
 	/* select client <client> */
 	if(v->sel->sel)
-		bufprint("select client %C\n", v->sel->sel->client);
+		fmtprint(&f, "select client %C\n", v->sel->sel->client);
 
 	foreach_area(v, s, a)
-		bufprint("colmode %a %s\n", a, column_getmode(a));
-	return buffer;
+		fmtprint(&f, "colmode %a %s\n", a, column_getmode(a));
+	return fmtstrflush(&f);
 }
 
 char*
@@ -748,6 +786,16 @@ msg_debug(IxpMsg *m) {
 		add = '+';
 		if(opt[0] == '+' || opt[0] == '-')
 			add = *opt++;
+		if(!strcmp(opt, "trace")) {
+			opt = msg_getword(m);
+			if(opt && !strcmp(opt, "on"))
+				trace_start();
+			else if(opt && !strcmp(opt, "off"))
+				trace_stop();
+			else
+				return "usage: debug trace on|off";
+			continue;
+		}
 		d = _bsearch(opt, debugtab, nelem(debugtab));
 		if(d == -1) {
 			bufprint(", %s", opt);
@@ -793,6 +841,7 @@ msg_grow(View *v, IxpMsg *m) {
 	Point amount;
 	int dir;
 
+	view_batcharrange();
 	f = getframe(v, screen->idx, m);
 	if(f == nil)
 		return "bad frame";
@@ -839,6 +888,7 @@ msg_nudge(View *v, IxpMsg *m) {
 	Point amount;
 	int dir;
 
+	view_batcharrange();
 	f = getframe(v, screen->idx, m);
 	if(f == nil)
 		return "bad frame";
@@ -992,6 +1042,7 @@ msg_selectframe(Area *a, IxpMsg *m, int sym) {
 			return Ebadvalue;
 	}
 	else {
+		view_batcharrange();
 		if(!find(&a, &f, DIR(sym), true, stack))
 			return Ebadvalue;
 	}
@@ -1102,6 +1153,7 @@ msg_sendclient(View *v, IxpMsg *m, bool swap) {
 		if(!f->anext && f == f->area->frame) {
 			ff = f;
 			to = a;
+			view_batcharrange();
 			if(!find(&to, &ff, DIR(sym), false, false))
 				return Ebadvalue;
 		}
@@ -1125,6 +1177,7 @@ msg_sendframe(Frame *f, int sym, bool swap) {
 
 	a = f->area;
 	fp = f;
+	view_batcharrange();
 	if(!find(&a, &fp, DIR(sym), false, false))
 		return Ebadvalue;
 	if(a != f->area)
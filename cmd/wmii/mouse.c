@@ -2,6 +2,7 @@
  * See LICENSE file for license details.
  */
 #include "dat.h"
+#include <sys/select.h>
 #include "fns.h"
 
 /* Here be dragons. */
@@ -128,13 +129,39 @@ snap_vline(const Rectangle *rects, int nrect, int dx, const Rectangle *r, int x)
 
 #undef frob
 
+/* The floating frames' edges are looked up in their index, and the
+ * screens', of which there are few, one by one.
+ */
+static int
+snap_line(View *v, Frame *ignore, bool vert, int d, const Rectangle *r, int xy) {
+	Rectangle rects[2];
+	int i;
+
+	if(vert)
+		d = edges_snap(&v->floating->edges, true, xy, r->min.y, r->max.y, d, ignore);
+	else
+		d = edges_snap(&v->floating->edges, false, xy, r->min.x, r->max.x, d, ignore);
+	for(i=0; i < nscreens; i++) {
+		rects[0] = v->r[i];
+		rects[1] = screens[i]->r;
+		if(vert)
+			d = snap_vline(rects, nelem(rects), d, r, xy);
+		else
+			d = snap_hline(rects, nelem(rects), d, r, xy);
+	}
+	return d;
+}
+
 /* Returns a gravity for increment handling. It's normally the
  * opposite of the mask (the directions that we're resizing in),
  * unless a snap occurs, in which case, it's the direction of the
  * snap.
+ *
+ * Snaps to the edges of v's floating frames, other than ignore, as
+ * of the last float_sync, and of its screens.
  */
 Align
-snap_rect(const Rectangle *rects, int num, Rectangle *r, Align *mask, int snap) {
+snap_rect(View *v, Frame *ignore, Rectangle *r, Align *mask, int snap) {
 	Align ret;
 	Point d;
 	
@@ -142,14 +169,14 @@ snap_rect(const Rectangle *rects, int num, Rectangle *r, Align *mask, int snap)
 	d.y = snap+1;
 
 	if(*mask&North)
-		d.y = snap_hline(rects, num, d.y, r, r->min.y);
+		d.y = snap_line(v, ignore, false, d.y, r, r->min.y);
 	if(*mask&South)
-		d.y = snap_hline(rects, num, d.y, r, r->max.y);
+		d.y = snap_line(v, ignore, false, d.y, r, r->max.y);
 
 	if(*mask&East)
-		d.x = snap_vline(rects, num, d.x, r, r->max.x);
+		d.x = snap_line(v, ignore, true, d.x, r, r->max.x);
 	if(*mask&West)
-		d.x = snap_vline(rects, num, d.x, r, r->min.x);
+		d.x = snap_line(v, ignore, true, d.x, r, r->min.x);
 
 	ret = Center;
 	if(abs(d.x) <= snap)
@@ -166,30 +193,124 @@ snap_rect(const Rectangle *rects, int num, Rectangle *r, Align *mask, int snap)
 	return ret ^ *mask;
 }
 
-int
-readmouse(Point *p, uint *button) {
-	XEvent ev;
+/* Waits until the X connection has something to read, or until
+ * deadline passes. Returns false in the latter case.
+ */
+static bool
+waitdisplay(uvlong deadline) {
+	struct timeval tv;
+	fd_set fds;
+	uvlong now;
+
+	now = stats_time();
+	if(now >= deadline)
+		return false;
+	tv.tv_sec = (deadline - now) / 1000000;
+	tv.tv_usec = (deadline - now) % 1000000;
+	FD_ZERO(&fds);
+	FD_SET(ConnectionNumber(display), &fds);
+	return select(ConnectionNumber(display) + 1, &fds, nil, nil, &tv) > 0;
+}
+
+static Bool
+findmotion(Display *d, XEvent *e, XPointer v) {
+	bool *blocked;
+
+	USED(d);
+	blocked = (bool*)v;
+	if(*blocked)
+		return false;
+	if(e->type == ButtonPress || e->type == ButtonRelease)
+		*blocked = true;
+	return e->type == MotionNotify;
+}
+
+/* Reads the next pointer event into ev, dispatching any exposures
+ * and the like which come first. A motion event is replaced by the
+ * last of those queued behind it, up to the next button event. With
+ * a deadline, returns false if it passes before anything arrives.
+ */
+static bool
+nextmouse(XEvent *ev, uvlong deadline) {
+	bool blocked;
 
 	for(;;) {
-		XMaskEvent(display, MouseMask|ExposureMask|StructureNotifyMask|PropertyChangeMask, &ev);
-		switch(ev.type) {
+		if(deadline == 0)
+			XMaskEvent(display, MouseMask|ExposureMask|StructureNotifyMask|PropertyChangeMask, ev);
+		else if(!XCheckMaskEvent(display, MouseMask|ExposureMask|StructureNotifyMask|PropertyChangeMask, ev)) {
+			if(!waitdisplay(deadline))
+				return false;
+			continue;
+		}
+		switch(ev->type) {
 		case ConfigureNotify:
 		case Expose:
 		case NoExpose:
 		case PropertyNotify:
-			dispatch_event(&ev);
+			dispatch_event(ev);
 		default:
 			continue;
+		case MotionNotify:
+			blocked = false;
+			while(XCheckIfEvent(display, ev, findmotion, (XPointer)&blocked))
+				stats.motion_compressed++;
 		case ButtonPress:
 		case ButtonRelease:
-			*button = ev.xbutton.button;
-		case MotionNotify:
-			p->x = ev.xmotion.x_root;
-			p->y = ev.xmotion.y_root;
 			break;
 		}
-		return ev.type;
+		return true;
+	}
+}
+
+static int
+mouseevent(XEvent *ev, Point *p, uint *button) {
+	switch(ev->type) {
+	case ButtonPress:
+	case ButtonRelease:
+		*button = ev->xbutton.button;
+	case MotionNotify:
+		p->x = ev->xmotion.x_root;
+		p->y = ev->xmotion.y_root;
+	}
+	return ev->type;
+}
+
+int
+readmouse(Point *p, uint *button) {
+	XEvent ev;
+
+	nextmouse(&ev, 0);
+	return mouseevent(&ev, p, button);
+}
+
+/* Like readmouse, for drags which reshape windows as they go.
+ * Motion is only returned once per display refresh, always with the
+ * latest position, and any that's left over when a button event
+ * arrives, or when the pointer comes to rest, is returned first.
+ */
+int
+readdrag(Point *p, uint *button) {
+	static uvlong last;
+	XEvent ev;
+	uvlong interval;
+	bool pending;
+
+	interval = 1000000 / (randr_refresh() > 0 ? randr_refresh() : 60);
+	for(pending=false;; pending=true) {
+		if(!nextmouse(&ev, pending ? last + interval : 0))
+			break;
+		if(ev.type != MotionNotify && pending) {
+			XPutBackEvent(display, &ev);
+			break;
+		}
+		mouseevent(&ev, p, button);
+		if(ev.type != MotionNotify)
+			return ev.type;
+		if(stats_time() >= last + interval)
+			break;
 	}
+	last = stats_time();
+	return MotionNotify;
 }
 
 bool
@@ -197,7 +318,7 @@ readmotion(Point *p) {
 	uint button;
 
 	for(;;)
-		switch(readmouse(p, &button)) {
+		switch(readdrag(p, &button)) {
 		case MotionNotify:
 			return true;
 		case ButtonRelease:
@@ -358,13 +479,11 @@ done:
 
 void
 mouse_resize(Client *c, Align align, bool grabmod) {
-	Rectangle *rects;
 	Rectangle frect, origin;
 	Align grav;
 	Cursor cur;
 	Point d, pt, hr;
 	float rx, ry, hrx, hry;
-	uint nrect;
 	Frame *f;
 
 	f = c->sel;
@@ -389,7 +508,7 @@ mouse_resize(Client *c, Align align, bool grabmod) {
 
 	origin = f->r;
 	frect = f->r;
-	rects = view_rects(f->area->view, &nrect, c->frame);
+	float_sync(f->area);
 
 	pt = querypointer(c->framewin);
 	rx = (float)pt.x / Dx(frect);
@@ -441,7 +560,7 @@ mouse_resize(Client *c, Align align, bool grabmod) {
 		rect_morph(&origin, d, &align);
 		frect = constrain(origin, -1);
 
-		grav = snap_rect(rects, nrect, &frect, &align, def.snap);
+		grav = snap_rect(f->view, f, &frect, &align, def.snap);
 
 		frect = frame_hints(f, frect, grav);
 		frect = constrain(frect, -1);
@@ -456,7 +575,6 @@ mouse_resize(Client *c, Align align, bool grabmod) {
 		pt.y = scr.rect.max.y - 1;
 	warppointer(pt);
 
-	free(rects);
 	ungrabpointer();
 }
 
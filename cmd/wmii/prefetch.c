@@ -0,0 +1,144 @@
+/* Copyright ©2009 Kris Maglione <maglione.k at Gmail>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include <X11/Xlib-xcb.h>
+#include <xcb/xcb.h>
+#include "fns.h"
+
+/* The properties read while a client is being adopted. */
+static char*	props[] = {
+	"WM_CLASS",
+	"WM_CLIENT_LEADER",
+	"WM_HINTS",
+	"WM_NAME",
+	"WM_NORMAL_HINTS",
+	"WM_PROTOCOLS",
+	"WM_TRANSIENT_FOR",
+	"_MOTIF_WM_HINTS",
+	"_NET_WM_NAME",
+	"_NET_WM_STATE",
+	"_NET_WM_STRUT",
+	"_NET_WM_STRUT_PARTIAL",
+	"_NET_WM_WINDOW_TYPE",
+	"_WMII_TAGS",
+};
+
+enum {
+	/* In 32 bit units. Longer properties are left to Xlib. */
+	PropLength = 1<<14,
+};
+
+typedef struct Cookies Cookies;
+struct Cookies {
+	xcb_get_window_attributes_cookie_t	attr;
+	xcb_get_geometry_cookie_t		geom;
+	xcb_get_property_cookie_t		prop[nelem(props)];
+};
+
+static Visual*
+findvisual(VisualID id) {
+	static Visual *last;
+	XVisualInfo tmpl, *vi;
+	int n;
+
+	if(last && XVisualIDFromVisual(last) == id)
+		return last;
+	tmpl.visualid = id;
+	vi = XGetVisualInfo(display, VisualIDMask, &tmpl, &n);
+	if(vi == nil)
+		return scr.visual;
+	last = vi->visual;
+	XFree(vi);
+	return last;
+}
+
+static void
+setattr(XWindowAttributes *wa, xcb_get_window_attributes_reply_t *ar,
+	xcb_get_geometry_reply_t *gr) {
+
+	wa->x = gr->x;
+	wa->y = gr->y;
+	wa->width = gr->width;
+	wa->height = gr->height;
+	wa->border_width = gr->border_width;
+	wa->depth = gr->depth;
+	wa->root = gr->root;
+	wa->screen = ScreenOfDisplay(display, scr.screen);
+
+	wa->visual = findvisual(ar->visual);
+	wa->class = ar->_class;
+	wa->bit_gravity = ar->bit_gravity;
+	wa->win_gravity = ar->win_gravity;
+	wa->backing_store = ar->backing_store;
+	wa->backing_planes = ar->backing_planes;
+	wa->backing_pixel = ar->backing_pixel;
+	wa->save_under = ar->save_under;
+	wa->colormap = ar->colormap;
+	wa->map_installed = ar->map_is_installed;
+	wa->map_state = ar->map_state;
+	wa->all_event_masks = ar->all_event_masks;
+	wa->your_event_mask = ar->your_event_mask;
+	wa->do_not_propagate_mask = ar->do_not_propagate_mask;
+	wa->override_redirect = ar->override_redirect;
+}
+
+/*
+ * Fetches the attributes, geometry, and client properties of each of
+ * the given windows, issuing every request before waiting on any
+ * reply, so that adopting n windows costs one round trip rather than
+ * a dozen or so per window. The properties are left in the property
+ * cache, which the caller must empty with propcache_flush once the
+ * windows have been adopted. wa[i].root is None for windows which
+ * no longer exist.
+ */
+void
+prefetch_windows(XWindow *wins, int n, XWindowAttributes *wa) {
+	xcb_connection_t *conn;
+	xcb_get_window_attributes_reply_t *ar;
+	xcb_get_geometry_reply_t *gr;
+	xcb_get_property_reply_t *pr;
+	xcb_generic_error_t *err;
+	Atom atoms[nelem(props)];
+	Cookies *c;
+	int i, j;
+
+	conn = XGetXCBConnection(display);
+	xatoms(props, nelem(props));
+	for(j=0; j < nelem(props); j++)
+		atoms[j] = xatom(props[j]);
+
+	c = emalloc(n * sizeof *c);
+	for(i=0; i < n; i++) {
+		c[i].attr = xcb_get_window_attributes(conn, wins[i]);
+		c[i].geom = xcb_get_geometry(conn, wins[i]);
+		for(j=0; j < nelem(props); j++)
+			c[i].prop[j] = xcb_get_property(conn, false, wins[i], atoms[j],
+							XCB_GET_PROPERTY_TYPE_ANY, 0, PropLength);
+	}
+
+	for(i=0; i < n; i++) {
+		memset(&wa[i], 0, sizeof wa[i]);
+		ar = xcb_get_window_attributes_reply(conn, c[i].attr, &err);
+		free(err);
+		gr = xcb_get_geometry_reply(conn, c[i].geom, &err);
+		free(err);
+		if(ar && gr)
+			setattr(&wa[i], ar, gr);
+
+		for(j=0; j < nelem(props); j++) {
+			pr = xcb_get_property_reply(conn, c[i].prop[j], &err);
+			free(err);
+			/* Missing properties are cached, too, with a type of None. */
+			if(pr && ar && gr && pr->bytes_after == 0)
+				propcache_add(wins[i], atoms[j], pr->type, pr->format,
+					      xcb_get_property_value(pr),
+					      xcb_get_property_value_length(pr));
+			free(pr);
+		}
+		free(ar);
+		free(gr);
+	}
+	free(c);
+}
+
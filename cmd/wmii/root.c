@@ -47,7 +47,11 @@ static void
 mapreq_event(Window *w, XMapRequestEvent *e) {
 	XWindowAttributes wa;
 
-	if(!XGetWindowAttributes(display, e->window, &wa))
+	/* Managed windows need nothing fetched. */
+	if(win2client(e->window))
+		return;
+	prefetch_windows(&e->window, 1, &wa);
+	if(wa.root == None)
 		return;
 	if(wa.override_redirect) {
 		/* Do I really want these? */
@@ -55,10 +59,11 @@ mapreq_event(Window *w, XMapRequestEvent *e) {
 		XSelectInput(display, e->window,
 			 PropertyChangeMask | StructureNotifyMask);
 		*/
+		propcache_flush();
 		return;
 	}
-	if(!win2client(e->window))
-		client_create(e->window, &wa);
+	client_create(e->window, &wa);
+	propcache_flush();
 }
 
 static void
@@ -22,9 +22,45 @@ trim(char *str, const char *chars) {
 	*q = '\0';
 }
 
+/* Compiles the rules into a single machine, which finds the first
+ * to match a string in one pass, rather than one per rule.
+ */
+static void
+compile(Ruleset *rs) {
+	Reprog **progs;
+	Rule *r;
+	int n;
+
+	regfreeset(rs->set);
+	n = 0;
+	for(r=rs->rule; r; r=r->next)
+		n++;
+	progs = emalloc((n + 1) * sizeof *progs);
+	n = 0;
+	for(r=rs->rule; r; r=r->next)
+		progs[n++] = r->regex;
+	rs->set = regcompset(progs, n);
+	free(progs);
+}
+
+Rule*
+rule_match(Ruleset *rs, char *s) {
+	Rule *r;
+	int n;
+
+	if(rs->set == nil)
+		return nil;
+	n = regexecset(rs->set, s);
+	if(n < 0)
+		return nil;
+	for(r=rs->rule; n--; r=r->next)
+		;
+	return r;
+}
+
 /* XXX: I hate this. --KM */
 void
-update_rules(Rule **rule, const char *data) {
+update_rules(Ruleset *rs, const char *data) {
 	/* basic rule matching language /regex/ -> value
 	 * regex might contain POSIX regex syntax defined in regex(3) */
 	enum {
@@ -34,7 +70,7 @@ update_rules(Rule **rule, const char *data) {
 		COMMENT,
 	};
 	int state;
-	Rule *rul;
+	Rule **rule, *rul;
 	char regex[256], value[256];
 	char *regex_end = regex + sizeof(regex) - 1;
 	char *value_end = value + sizeof(value) - 1;
@@ -47,9 +83,10 @@ update_rules(Rule **rule, const char *data) {
 
 	if(!data || !strlen(data))
 		return;
+	rule = &rs->rule;
 	while((rul = *rule)) {
 		*rule = rul->next;
-		free(rul->regex);
+		regfree(rul->regex);
 		free(rul);
 	}
 	state = IGNORE;
@@ -104,4 +141,5 @@ update_rules(Rule **rule, const char *data) {
 		default: /* can't happen */
 			die("invalid state");
 		}
+	compile(rs);
 }
@@ -0,0 +1,498 @@
+/* Copyright ©2009 Kris Maglione <maglione.k at Gmail>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fns.h"
+
+/* The layout of every view is saved to a file before an exec restart
+ * and reloaded while the new instance adopts its windows, so that
+ * frames go straight back into their old columns, in their old order,
+ * with their old sizes. The file is a flat little-endian dump:
+ *
+ *	"wmii-state 1" nscreens[2] selview[s] nview[2] View*
+ *	View:	name[s] selscreen[2] selcol[2] floatmax[1]
+ *		(ncol[2] (mode[1] width[4])*)*nscreens nframe[4] Frame*
+ *	Frame:	xid[4] screen[2] column[2] index[2] flags[1] colr[16] floatr[16]
+ *
+ * where [s] is a string with a two byte length, and a screen of
+ * 0xffff denotes the floating layer.
+ */
+
+#define MAGIC "wmii-state 1"
+
+enum {
+	Floating = 0xffff,
+};
+
+enum {
+	FCollapsed = 1<<0,
+	FSel = 1<<1,
+};
+
+typedef struct Buf Buf;
+typedef struct SavedCol SavedCol;
+typedef struct SavedFrame SavedFrame;
+typedef struct SavedView SavedView;
+
+struct Buf {
+	uchar*	data;
+	uchar*	pos;
+	uchar*	end;
+	bool	err;
+};
+
+struct SavedCol {
+	int	mode;
+	int	width;
+};
+
+struct SavedView {
+	SavedView*	next;
+	char*		name;
+	int		selscreen;
+	int		selcol;
+	bool		floatmax;
+	int*		ncol;
+	SavedCol**	cols;
+	bool		placed;
+};
+
+struct SavedFrame {
+	SavedFrame*	next;
+	SavedView*	view;
+	int		screen;
+	int		column;
+	int		index;
+	int		flags;
+	Rectangle	colr;
+	Rectangle	floatr;
+};
+
+static MapEnt*	fbucket[137];
+static Map	framemap = { fbucket, nelem(fbucket) };
+
+static struct {
+	SavedView*	views;
+	char*		selview;
+	Vector_long	wins;
+	bool		loaded;
+} saved;
+
+static void
+put(Buf *b, ulong v, int n) {
+	int size, off;
+
+	if(b->pos + n > b->end) {
+		off = b->pos - b->data;
+		size = max(4096, 2 * (b->end - b->data));
+		b->data = erealloc(b->data, size);
+		b->pos = b->data + off;
+		b->end = b->data + size;
+	}
+	while(n--) {
+		*b->pos++ = v;
+		v >>= 8;
+	}
+}
+
+static void
+putstr(Buf *b, char *s) {
+	int n;
+
+	n = strlen(s);
+	put(b, n, 2);
+	while(n--)
+		put(b, *s++, 1);
+}
+
+static void
+putrect(Buf *b, Rectangle r) {
+	put(b, r.min.x, 4);
+	put(b, r.min.y, 4);
+	put(b, r.max.x, 4);
+	put(b, r.max.y, 4);
+}
+
+static ulong
+get(Buf *b, int n) {
+	ulong v;
+	int i;
+
+	if(b->err || b->pos + n > b->end) {
+		b->err = true;
+		return 0;
+	}
+	v = 0;
+	for(i=0; i < n; i++)
+		v |= (ulong)b->pos[i] << 8*i;
+	b->pos += n;
+	return v;
+}
+
+static char*
+getstr(Buf *b) {
+	char *s;
+	int n;
+
+	n = get(b, 2);
+	if(b->err || b->pos + n > b->end) {
+		b->err = true;
+		return estrdup("");
+	}
+	s = emalloc(n + 1);
+	memcpy(s, b->pos, n);
+	s[n] = '\0';
+	b->pos += n;
+	return s;
+}
+
+static int
+getint(Buf *b) {
+	return (int)(uint)get(b, 4);
+}
+
+static Rectangle
+getrect(Buf *b) {
+	Rectangle r;
+
+	r.min.x = getint(b);
+	r.min.y = getint(b);
+	r.max.x = getint(b);
+	r.max.y = getint(b);
+	return r;
+}
+
+static void
+putview(Buf *b, View *v) {
+	Frame *f;
+	Area *a;
+	int s, i, n;
+
+	putstr(b, v->name);
+	if(v->sel->floating) {
+		put(b, Floating, 2);
+		put(b, 0, 2);
+	}else {
+		put(b, v->sel->screen, 2);
+		put(b, area_idx(v->sel), 2);
+	}
+	put(b, v->floating->max, 1);
+
+	for(s=0; s < nscreens; s++) {
+		n = 0;
+		for(a=v->areas[s]; a; a=a->next)
+			n++;
+		put(b, n, 2);
+		for(a=v->areas[s]; a; a=a->next) {
+			put(b, a->mode, 1);
+			put(b, Dx(a->r), 4);
+		}
+	}
+
+	n = 0;
+	foreach_frame(v, s, a, f)
+		n++;
+	put(b, n, 4);
+	foreach_area(v, s, a) {
+		i = 0;
+		for(f=a->frame; f; f=f->anext) {
+			put(b, f->client->w.xid, 4);
+			put(b, a->floating ? Floating : a->screen, 2);
+			put(b, a->floating ? 0 : area_idx(a), 2);
+			put(b, i++, 2);
+			put(b, (f->collapsed ? FCollapsed : 0)
+			     | (a->sel == f ? FSel : 0), 1);
+			putrect(b, f->colr);
+			putrect(b, f->floatr);
+		}
+	}
+}
+
+/* Writes the current layout to path. Called just before an exec
+ * restart.
+ */
+bool
+state_save(char *path) {
+	Buf b;
+	View *v;
+	int fd, n;
+	bool ret;
+
+	memset(&b, 0, sizeof b);
+	for(n=0; MAGIC[n]; n++)
+		put(&b, MAGIC[n], 1);
+	put(&b, nscreens, 2);
+	putstr(&b, selview ? selview->name : "");
+	n = 0;
+	for(v=view; v; v=v->next)
+		n++;
+	put(&b, n, 2);
+	for(v=view; v; v=v->next)
+		putview(&b, v);
+
+	ret = false;
+	fd = open(path, O_WRONLY|O_CREAT|O_TRUNC, 0600);
+	if(fd >= 0) {
+		n = b.pos - b.data;
+		ret = write(fd, b.data, n) == n;
+		close(fd);
+	}
+	if(!ret)
+		fprint(2, "%s: can't write state file %q: %r\n", argv0, path);
+	free(b.data);
+	return ret;
+}
+
+static SavedView*
+getview(Buf *b) {
+	SavedView *sv;
+	SavedFrame *sf;
+	XWindow w;
+	void **e;
+	int s, i, n;
+
+	sv = emallocz(sizeof *sv);
+	sv->name = getstr(b);
+	sv->selscreen = get(b, 2);
+	sv->selcol = get(b, 2);
+	sv->floatmax = get(b, 1);
+
+	sv->ncol = emallocz(nscreens * sizeof *sv->ncol);
+	sv->cols = emallocz(nscreens * sizeof *sv->cols);
+	for(s=0; s < nscreens; s++) {
+		n = get(b, 2);
+		if(b->err)
+			break;
+		sv->ncol[s] = n;
+		sv->cols[s] = emallocz(n * sizeof *sv->cols[s]);
+		for(i=0; i < n; i++) {
+			sv->cols[s][i].mode = get(b, 1);
+			sv->cols[s][i].width = get(b, 4);
+		}
+	}
+
+	n = get(b, 4);
+	for(i=0; i < n && !b->err; i++) {
+		sf = emallocz(sizeof *sf);
+		sf->view = sv;
+		w = get(b, 4);
+		sf->screen = get(b, 2);
+		sf->column = get(b, 2);
+		sf->index = get(b, 2);
+		sf->flags = get(b, 1);
+		sf->colr = getrect(b);
+		sf->floatr = getrect(b);
+		if(sf->screen != Floating && sf->screen >= nscreens) {
+			free(sf);
+			continue;
+		}
+		e = map_get(&framemap, w, true);
+		if(*e == nil)
+			vector_lpush(&saved.wins, w);
+		sf->next = *e;
+		*e = sf;
+	}
+	return sv;
+}
+
+/* Loads the layout saved by state_save, and removes the file. From
+ * here until state_finish, view_attach places any frame with a saved
+ * slot via state_attach.
+ */
+void
+state_load(char *path) {
+	SavedView **svp;
+	struct stat st;
+	Buf b;
+	int fd, i, n;
+
+	fd = open(path, O_RDONLY);
+	if(fd < 0)
+		return;
+	unlink(path);
+
+	memset(&b, 0, sizeof b);
+	if(fstat(fd, &st) == 0) {
+		b.data = emalloc(st.st_size);
+		if(read(fd, b.data, st.st_size) == st.st_size) {
+			b.pos = b.data;
+			b.end = b.data + st.st_size;
+		}
+	}
+	close(fd);
+
+	b.err = b.pos == nil;
+	for(i=0; MAGIC[i]; i++)
+		if(get(&b, 1) != MAGIC[i])
+			b.err = true;
+	/* Don't bother with a layout for a different set of screens. */
+	if(b.err || get(&b, 2) != nscreens)
+		goto done;
+
+	saved.selview = getstr(&b);
+	n = get(&b, 2);
+	svp = &saved.views;
+	for(i=0; i < n && !b.err; i++) {
+		*svp = getview(&b);
+		svp = &(*svp)->next;
+	}
+	saved.loaded = true;
+done:
+	if(b.err)
+		fprint(2, "%s: state file %q is corrupt\n", argv0, path);
+	free(b.data);
+}
+
+static SavedFrame*
+findframe(XWindow w, View *v) {
+	SavedFrame *sf;
+	void **e;
+
+	e = map_get(&framemap, w, false);
+	if(e)
+		for(sf=*e; sf; sf=sf->next)
+			if(!strcmp(sf->view->name, v->name))
+				return sf;
+	return nil;
+}
+
+/* Gives a view the columns it had before the restart. */
+static void
+placeview(View *v, SavedView *sv) {
+	Area *a;
+	int s, i;
+
+	sv->placed = true;
+	for(s=0; s < nscreens; s++) {
+		a = v->areas[s];
+		for(i=0; i < sv->ncol[s]; i++) {
+			if(a == nil)
+				a = column_new(v, nil, s, sv->cols[s][i].width);
+			else if(i > 0 && a->next == nil)
+				a = column_new(v, a, s, sv->cols[s][i].width);
+			else if(i > 0)
+				a = a->next;
+			if(a == nil)
+				break;
+			a->mode = sv->cols[s][i].mode;
+		}
+	}
+	v->floating->max = sv->floatmax;
+}
+
+/* Puts f into its saved slot in v, if it has one, without arranging
+ * anything. The view is arranged once, by state_finish.
+ */
+bool
+state_attach(View *v, Frame *f) {
+	SavedFrame *sf, *sp;
+	Frame *ff, *pos;
+	Client *c;
+	Area *a;
+
+	if(!saved.loaded)
+		return false;
+
+	c = f->client;
+	sf = findframe(c->w.xid, v);
+	if(sf == nil || c->fullscreen >= 0)
+		return false;
+
+	if(!sf->view->placed)
+		placeview(v, sf->view);
+
+	if(sf->screen == Floating)
+		a = v->floating;
+	else
+		a = view_findarea(v, sf->screen, sf->column, false);
+	if(a == nil)
+		return false;
+
+	/* Keep frames in their saved order. */
+	pos = nil;
+	for(ff=a->frame; ff; pos=ff, ff=ff->anext) {
+		sp = findframe(ff->client->w.xid, v);
+		if(sp == nil || sp->index > sf->index)
+			break;
+	}
+
+	f->area = a;
+	f->collapsed = (sf->flags & FCollapsed) != 0;
+	f->colr = sf->colr;
+	f->floatr = sf->floatr;
+	if(a->floating) {
+		c->floating = true;
+		f->r = f->floatr;
+		frame_insert(f, pos);
+	}else
+		column_insert(a, f, pos);
+	if(a->sel == nil || sf->flags & FSel)
+		a->sel = f;
+
+	if(c->sel == nil)
+		c->sel = f;
+	return true;
+}
+
+static void
+freeview(SavedView *sv) {
+	int s;
+
+	for(s=0; s < nscreens; s++)
+		free(sv->cols[s]);
+	free(sv->cols);
+	free(sv->ncol);
+	free(sv->name);
+	free(sv);
+}
+
+/* Arranges each restored view once, restores its selection, and
+ * frees the saved layout.
+ */
+void
+state_finish(void) {
+	SavedView *sv, *next;
+	SavedFrame *sf, *snext;
+	View *v;
+	Area *a;
+	int s, i;
+
+	if(!saved.loaded)
+		return;
+	saved.loaded = false;
+
+	for(sv=saved.views; sv; sv=next) {
+		next = sv->next;
+		if(sv->placed && (v = view_find(sv->name))) {
+			for(s=0; s < nscreens; s++)
+				for(a=v->areas[s], i=0; a && i < sv->ncol[s]; a=a->next, i++)
+					a->r.max.x = a->r.min.x + sv->cols[s][i].width;
+			view_arrange(v);
+
+			if(sv->selscreen == Floating)
+				a = v->floating;
+			else if(sv->selscreen < nscreens)
+				a = view_findarea(v, sv->selscreen, sv->selcol, false);
+			else
+				a = nil;
+			if(a && (a->frame || !a->floating))
+				area_focus(a);
+		}
+		freeview(sv);
+	}
+	saved.views = nil;
+
+	if(saved.selview[0] && view_find(saved.selview))
+		view_select(saved.selview);
+	free(saved.selview);
+
+	for(i=0; i < saved.wins.n; i++)
+		for(sf=map_rm(&framemap, saved.wins.ary[i]); sf; sf=snext) {
+			snext = sf->next;
+			free(sf);
+		}
+	saved.wins.n = 0;
+}
@@ -0,0 +1,130 @@
+/* Copyright ©2009 Kris Maglione <maglione.k at Gmail>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include <sys/time.h>
+#include "fns.h"
+
+/* Counters behind /debug/stats. Updating one costs a handful of
+ * instructions and, for timings, a clock read; nothing is formatted
+ * until the file is read.
+ *
+ * Plain counters are printed as "<name> <count>", and histograms as:
+ *
+ *	<name> <count> <total> <max> <bucket>...
+ *
+ * where bucket i counts the samples v with 2^(i-1) <= v < 2^i (the
+ * first counts zeros, the last everything larger). Times are in
+ * microseconds.
+ */
+
+static char* fcnames[] = {
+	"Tversion", "Tauth", "Tattach", "Terror", "Tflush", "Twalk", "Topen",
+	"Tcreate", "Tread", "Twrite", "Tclunk", "Tremove", "Tstat", "Twstat",
+};
+
+/* The 9P request being served, from its arrival to its response. */
+static struct {
+	int	type;
+	int	tag;
+	uvlong	time;
+} req;
+
+uvlong
+stats_time(void) {
+	struct timeval tv;
+
+	gettimeofday(&tv, nil);
+	return (uvlong)tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+void
+stats_add(Histogram *h, ulong v) {
+	int i;
+
+	h->count++;
+	h->total += v;
+	if(v > h->max)
+		h->max = v;
+	for(i=0; v && i < NHistogram-1; i++)
+		v >>= 1;
+	h->bucket[i]++;
+}
+
+/* Called for each incoming 9P message. */
+void
+stats_9pin(Fcall *f) {
+	int i;
+
+	i = (f->hdr.type - TVersion) / 2;
+	if(i >= 0 && i < nelem(stats.nrequest))
+		stats.nrequest[i]++;
+	req.type = f->hdr.type;
+	req.tag = f->hdr.tag;
+	req.time = stats_time();
+}
+
+/* Called as each request is answered from fs.c. Requests which are
+ * answered later, like reads of /event, or by libixp itself, like
+ * directory reads, aren't timed.
+ */
+void
+stats_9pout(Ixp9Req *r) {
+	int i;
+
+	i = (r->ifcall.hdr.type - TVersion) / 2;
+	if(i < 0 || i >= nelem(stats.ninep))
+		return;
+	if(r->ifcall.hdr.type == req.type && r->ifcall.hdr.tag == req.tag) {
+		stats_add(&stats.ninep[i], stats_time() - req.time);
+		trace_end("9p", fcnames[i], req.time);
+		req.type = 0;
+	}
+}
+
+static void
+histfmt(Fmt *f, char *prefix, char *name, Histogram *h) {
+	int i, n;
+
+	fmtprint(f, "%s%s %lud %llud %lud", prefix, name, h->count, h->total, h->max);
+	for(n=NHistogram; n > 0 && h->bucket[n-1] == 0; n--)
+		;
+	for(i=0; i < n; i++)
+		fmtprint(f, " %lud", h->bucket[i]);
+	fmtprint(f, "\n");
+}
+
+char*
+stats_render(void) {
+	char buf[16];
+	Fmt f;
+	int i;
+
+	fmtstrinit(&f);
+	for(i=0; i < nelem(stats.ninep); i++)
+		if(stats.nrequest[i]) {
+			fmtprint(&f, "9p.%s.requests %lud\n", fcnames[i], stats.nrequest[i]);
+			histfmt(&f, "9p.", fcnames[i], &stats.ninep[i]);
+		}
+	for(i=0; i < nelem(stats.event); i++)
+		if(stats.event[i].count) {
+			snprint(buf, sizeof buf, "%d", i);
+			histfmt(&f, "event.", eventname(i) ? eventname(i) : buf, &stats.event[i]);
+		}
+	histfmt(&f, "event.", "xrequests", &stats.xrequests);
+	histfmt(&f, "event.", "queue", &stats.queue);
+	histfmt(&f, "", "view_arrange", &stats.view_arrange);
+	histfmt(&f, "", "column_arrange", &stats.column_arrange);
+	fmtprint(&f, "view_update %lud\n", stats.view_update);
+	fmtprint(&f, "view_restack %lud\n", stats.view_restack);
+	fmtprint(&f, "frame_draw %lud\n", stats.frame_draw);
+	fmtprint(&f, "bar_damage %lud\n", stats.bar_damage);
+	fmtprint(&f, "bar_draw %lud\n", stats.bar_draw);
+	fmtprint(&f, "motion_compressed %lud\n", stats.motion_compressed);
+	fmtprint(&f, "ibuf.alloc %lud\n", stats.ibuf_alloc);
+	fmtprint(&f, "ibuf.hit %lud\n", stats.ibuf_hit);
+	fmtprint(&f, "ibuf.count %lud\n", stats.ibuf_count);
+	fmtprint(&f, "ibuf.bytes %lud\n", stats.ibuf_bytes);
+	return fmtstrflush(&f);
+}
+
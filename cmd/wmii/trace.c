@@ -0,0 +1,91 @@
+/* Copyright ©2009 Kris Maglione <maglione.k at Gmail>
+ * See LICENSE file for license details.
+ */
+#include "dat.h"
+#include "fns.h"
+
+/* A timeline of X event dispatch, 9P requests, and the heavier
+ * internal phases, kept while 'debug trace on' is in effect. The
+ * spans are kept in a ring, so only the most recent NSpan survive,
+ * and are read from /debug/trace in the Trace Event Format understood
+ * by chrome://tracing and its descendants.
+ *
+ * Names must be static strings; nothing is copied while recording.
+ */
+
+enum {
+	NSpan = 1<<15,
+};
+
+typedef struct Span Span;
+struct Span {
+	char*	cat;
+	char*	name;
+	uvlong	ts;
+	ulong	dur;
+};
+
+static struct {
+	Span*	ring;
+	ulong	n;
+	bool	on;
+} trace;
+
+void
+trace_start(void) {
+	if(trace.ring == nil)
+		trace.ring = emalloc(NSpan * sizeof *trace.ring);
+	trace.n = 0;
+	trace.on = true;
+}
+
+void
+trace_stop(void) {
+	trace.on = false;
+}
+
+/* Returns the start time of a span, or 0 when not tracing. */
+uvlong
+trace_begin(void) {
+	if(!trace.on)
+		return 0;
+	return stats_time();
+}
+
+void
+trace_end(char *cat, char *name, uvlong start) {
+	Span *s;
+
+	if(!trace.on || start == 0)
+		return;
+	s = &trace.ring[trace.n++ % NSpan];
+	s->cat = cat;
+	s->name = name;
+	s->ts = start;
+	s->dur = stats_time() - start;
+}
+
+char*
+trace_render(void) {
+	Span *s;
+	Fmt f;
+	char *sep;
+	ulong i;
+
+	fmtstrinit(&f);
+	fmtprint(&f, "{\"traceEvents\":[");
+	sep = "";
+	i = 0;
+	if(trace.n > NSpan)
+		i = trace.n - NSpan;
+	for(; i < trace.n; i++) {
+		s = &trace.ring[i % NSpan];
+		fmtprint(&f, "%s\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\","
+			     "\"ts\":%llud,\"dur\":%lud,\"pid\":1,\"tid\":1}",
+			 sep, s->name, s->cat, s->ts, s->dur);
+		sep = ",";
+	}
+	fmtprint(&f, "\n]}\n");
+	return fmtstrflush(&f);
+}
+
@@ -5,6 +5,21 @@
 #include "dat.h"
 #include "fns.h"
 
+static MapEnt*	vbucket[137];
+static Map	viewmap = { vbucket, nelem(vbucket) };
+
+/* While a batch is open, view_update and view_restack only note
+ * that they're needed. The work is done once, in view_endbatch.
+ * Commands which read the layout bring it up to date first with
+ * view_batcharrange, which touches nothing in X.
+ */
+static struct {
+	int	depth;
+	bool	update;
+	bool	restack;
+	bool	dirty;
+} batch;
+
 static bool
 empty_p(View *v) {
 	Frame *f;
@@ -59,17 +74,15 @@ View*
 view_create(const char *name) {
 	static ushort id = 1;
 	View **vp;
-	Client *c;
 	View *v;
 	int i;
 
-	for(vp=&view; *vp; vp=&(*vp)->next) {
-		i = strcmp((*vp)->name, name);
-		if(i == 0)
-			return *vp;
-		if(i > 0)
+	if((v = view_find(name)))
+		return v;
+
+	for(vp=&view; *vp; vp=&(*vp)->next)
+		if(strcmp((*vp)->name, name) > 0)
 			break;
-	}
 
 	v = emallocz(sizeof *v);
 	v->id = id++;
@@ -91,12 +104,10 @@ view_create(const char *name) {
 
 	v->next = *vp;
 	*vp = v;
+	*hash_get(&viewmap, v->name, true) = v;
 
 	/* FIXME: Belongs elsewhere */
-	/* FIXME: Can do better. */
-	for(c=client; c; c=c->next)
-		if(c != kludge)
-			apply_tags(c, c->tags);
+	apply_tagre(v);
 
 	view_arrange(v);
 	if(!selview)
@@ -128,9 +139,11 @@ view_destroy(View *v) {
 		if(*vp == v) break;
 	*vp = v->next;
 	assert(v != v->next);
+	hash_rm(&viewmap, v->name);
 
-	/* Detach frames held here by regex tags. */
-	/* FIXME: Can do better. */
+	/* Detach frames held here by regex tags. Only the frames of
+	 * this view can be affected.
+	 */
 	foreach_frame(v, s, a, f)
 		apply_tags(f->client, f->client->tags);
 
@@ -153,6 +166,14 @@ view_destroy(View *v) {
 	ewmh_updateviews();
 }
 
+View*
+view_find(const char *name) {
+	void **e;
+
+	e = hash_get(&viewmap, name, false);
+	return e ? *e : nil;
+}
+
 Area*
 view_findarea(View *v, int screen, int idx, bool create) {
 	Area *a;
@@ -276,7 +297,13 @@ view_update(View *v) {
 		return;
 	if(starting)
 		return;
+	if(batch.depth) {
+		batch.update = true;
+		batch.dirty = true;
+		return;
+	}
 
+	stats.view_update++;
 	frames_update_sel(v);
 
 	foreach_frame(v, s, a, f)
@@ -315,6 +342,48 @@ view_update(View *v) {
 	frame_draw_all();
 }
 
+void
+view_beginbatch(void) {
+	batch.depth++;
+}
+
+bool
+view_batching(void) {
+	return batch.depth > 0;
+}
+
+void
+view_endbatch(void) {
+	bool update, restack;
+
+	assert(batch.depth > 0);
+	if(--batch.depth > 0)
+		return;
+
+	update = batch.update;
+	restack = batch.restack;
+	batch.update = false;
+	batch.restack = false;
+	batch.dirty = false;
+	if(update)
+		view_update(selview); /* performs view_restack */
+	else if(restack)
+		view_restack(selview);
+}
+
+/* Lays out the selected view, if an earlier command in the batch
+ * has changed it, so that frames' geometry can be read. Clients are
+ * configured and restacked only once, by view_endbatch.
+ */
+void
+view_batcharrange(void) {
+
+	if(!batch.depth || !batch.dirty)
+		return;
+	view_arrange(selview);
+	batch.dirty = false;
+}
+
 void
 view_focus(WMScreen *s, View *v) {
 	
@@ -348,6 +417,10 @@ view_attach(View *v, Frame *f) {
 	
 	c = f->client;
 
+	/* Restarting: put it back where it was. */
+	if(state_attach(v, f))
+		return;
+
 	oldsel = v->oldsel;
 	a = v->sel;
 	if(client_floats_p(c)) {
@@ -434,11 +507,18 @@ view_restack(View *v) {
 	Divide *d;
 	Frame *f;
 	Area *a;
+	uvlong t;
 	int s;
 	
 	if(v != selview)
 		return;
+	if(batch.depth) {
+		batch.restack = true;
+		return;
+	}
 
+	stats.view_restack++;
+	t = trace_begin();
 	wins.n = 0;
 
 	/* *sigh */
@@ -468,6 +548,7 @@ view_restack(View *v) {
 	ewmh_updatestacking();
 	if(wins.n)
 		XRestackWindows(display, (ulong*)wins.ary, wins.n);
+	trace_end("layout", "view_restack", t);
 }
 
 void
@@ -520,11 +601,13 @@ view_scale(View *v, int scrn, int width) {
 void
 view_arrange(View *v) {
 	Area *a;
+	uvlong t;
 	int s;
 
 	if(!v->firstarea)
 		return;
 
+	t = stats_time();
 	view_update_rect(v);
 	for(s=0; s < nscreens; s++)
 		view_scale(v, s, Dx(v->r[s]) + Dx(v->pad[s]));
@@ -536,28 +619,15 @@ view_arrange(View *v) {
 		a->r.max.y = v->r[s].max.y;
 		column_arrange(a, false);
 	}
-	if(v == selview)
-		div_update_all();
-}
-
-Rectangle*
-view_rects(View *v, uint *num, Frame *ignore) {
-	Vector_rect result;
-	Frame *f;
-	int i;
-
-	vector_rinit(&result);
-
-	for(f=v->floating->frame; f; f=f->anext)
-		if(f != ignore)
-			vector_rpush(&result, f->r);
-	for(i=0; i < nscreens; i++) {
-		vector_rpush(&result, v->r[i]);
-		vector_rpush(&result, screens[i]->r);
+	/* Dividers are windows, and wait for the end of a batch. */
+	if(v == selview) {
+		if(batch.depth)
+			batch.update = true;
+		else
+			div_update_all();
 	}
-
-	*num = result.n;
-	return result.ary;
+	stats_add(&stats.view_arrange, stats_time() - t);
+	trace_end("layout", "view_arrange", t);
 }
 
 void
@@ -582,49 +652,52 @@ view_newcolwidth(View *v, int num) {
 	Rule *r;
 	char *toks[16];
 	char buf[sizeof r->value];
+	uvlong t;
 	ulong n;
 
-	for(r=def.colrules.rule; r; r=r->next)
-		if(regexec(r->regex, v->name, nil, 0)) {
-			utflcpy(buf, r->value, sizeof buf);
-			n = tokenize(toks, 16, buf, '+');
-			if(num < n)
-				if(getulong(toks[num], &n))
-					return Dx(v->screenr) * (n / 100.0); /* XXX: Multihead. */
-			break;
-		}
+	t = trace_begin();
+	r = rule_match(&def.colrules, v->name);
+	trace_end("rules", "colrules", t);
+	if(r) {
+		utflcpy(buf, r->value, sizeof buf);
+		n = tokenize(toks, 16, buf, '+');
+		if(num < n)
+			if(getulong(toks[num], &n))
+				return Dx(v->screenr) * (n / 100.0); /* XXX: Multihead. */
+	}
 	return 0;
 }
 
 char*
 view_index(View *v) {
+	Fmt fmt;
 	Rectangle *r;
 	Frame *f;
 	Area *a;
 	int s;
 
-	bufclear();
+	fmtstrinit(&fmt);
 	foreach_area(v, s, a) {
 		if(a->floating)
-			bufprint("# %a %d %d\n", a, Dx(a->r), Dy(a->r));
+			fmtprint(&fmt, "# %a %d %d\n", a, Dx(a->r), Dy(a->r));
 		else
-			bufprint("# %a %d %d\n", a, a->r.min.x, Dx(a->r));
+			fmtprint(&fmt, "# %a %d %d\n", a, a->r.min.x, Dx(a->r));
 
 		for(f=a->frame; f; f=f->anext) {
 			r = &f->r;
 			if(a->floating)
-				bufprint("%a %C %d %d %d %d %s\n",
+				fmtprint(&fmt, "%a %C %d %d %d %d %s\n",
 						a, f->client,
 						r->min.x, r->min.y,
 						Dx(*r), Dy(*r),
 						f->client->props);
 			else
-				bufprint("%a %C %d %d %s\n",
+				fmtprint(&fmt, "%a %C %d %d %s\n",
 						a, f->client,
 						r->min.y, Dy(*r),
 						f->client->props);
 		}
 	}
-	return buffer;
+	return fmtstrflush(&fmt);
 }
 
@@ -4,6 +4,7 @@
 #define _X11_VISIBLE
 #define pointerwin __pointerwin
 #include "dat.h"
+#include <ctype.h>
 #include <limits.h>
 #include <math.h>
 #include <strings.h>
@@ -12,6 +13,8 @@
 #include "fns.h"
 #undef  pointerwin
 
+bool		glyphcache = true;
+
 const Point	ZP = {0, 0};
 const Rectangle	ZR = {{0, 0}, {0, 0}};
 
@@ -23,6 +26,26 @@ static Map	atommap;
 static MapEnt*	wbucket[137];
 static MapEnt*	abucket[137];
 
+/* Property values fetched ahead of time, in bulk, by propcache_add.
+ * getprop serves them without a round trip until propcache_flush is
+ * called. Changing or deleting a property drops its entry.
+ */
+typedef struct CachedProp CachedProp;
+struct CachedProp {
+	CachedProp*	next;
+	Atom		prop;
+	Atom		type;
+	int		format;
+	ulong		nbytes;
+	uchar*		data;
+};
+
+static MapEnt*	pbucket[137];
+static Map	propmap = { pbucket, nelem(pbucket) };
+static XWindow*	propwins;
+static int	npropwins;
+static int	propwinsize;
+
 static int	errorhandler(Display*, XErrorEvent*);
 static int	(*xlib_errorhandler) (Display*, XErrorEvent*);
 
@@ -533,6 +556,90 @@ drawline(Image *dst, Point p1, Point p2, int cap, int w, Color col) {
 	XDrawLine(display, dst->xid, dst->gc, p1.x, p1.y, p2.x, p2.y);
 }
 
+/* Returns the advance of rune r, consulting and filling the font's
+ * glyph cache.
+ */
+static int
+glyphadvance(Font *font, Rune r) {
+	short **page;
+	char buf[UTFmax];
+	int n, off;
+
+	if(!glyphcache) {
+		n = runetochar(buf, &r);
+		textextents_l(font, buf, n, &off);
+		return off;
+	}
+
+	if(font->advance == nil)
+		font->advance = emallocz(256 * sizeof *font->advance);
+	page = &font->advance[r >> 8];
+	if(*page == nil) {
+		*page = emalloc(256 * sizeof **page);
+		memset(*page, 0xff, 256 * sizeof **page);
+	}
+	if((*page)[r & 0xff] < 0) {
+		n = runetochar(buf, &r);
+		textextents_l(font, buf, n, &off);
+		(*page)[r & 0xff] = max(off, 0);
+	}
+	return (*page)[r & 0xff];
+}
+
+/* Shortens buf, of length len, so that it fits in width pixels when
+ * followed by up to three dots. The cut point is found by a binary
+ * search over the prefix sums of the glyph advances, and then checked
+ * against the real extents of the string. Returns the new length of
+ * buf, including the dots.
+ */
+static uint
+shortenstring(Font *font, char *buf, uint len, uint width, Rectangle *tr) {
+	Rune r;
+	int *sum, *off;
+	int i, n, lo, hi, mid, dotw, ndot;
+
+	sum = emalloc((len + 1) * sizeof *sum);
+	off = emalloc((len + 1) * sizeof *off);
+	sum[0] = 0;
+	off[0] = 0;
+	for(n=0, i=0; i < len; n++) {
+		i += chartorune(&r, buf+i);
+		sum[n+1] = sum[n] + glyphadvance(font, r);
+		off[n+1] = min(i, len);
+	}
+
+	/* Find the greatest number of runes, lo, which fits. */
+	dotw = glyphadvance(font, '.');
+	lo = 0;
+	hi = n - 1;
+	while(lo < hi) {
+		mid = (lo + hi + 1) / 2;
+		if(sum[mid] + min(n - mid, 3) * dotw <= (int)width)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	/* Advances ignore kerning and bearings. Back off until the
+	 * real extents fit.
+	 */
+	SET(ndot);
+	for(; lo > 0; lo--) {
+		ndot = min(n - lo, 3);
+		memset(buf + off[lo], '.', ndot);
+		*tr = textextents_l(font, buf, off[lo] + ndot, nil);
+		if(Dx(*tr) <= width)
+			break;
+	}
+
+	len = 0;
+	if(lo > 0)
+		len = off[lo] + ndot;
+	free(sum);
+	free(off);
+	return len;
+}
+
 uint
 drawstring(Image *dst, Font *font,
 	   Rectangle r, Align align,
@@ -540,9 +647,6 @@ drawstring(Image *dst, Font *font,
 	Rectangle tr;
 	char *buf;
 	uint x, y, width, height, len;
-	int shortened;
-
-	shortened = 0;
 
 	len = strlen(text);
 	buf = emalloc(len+1);
@@ -561,23 +665,15 @@ drawstring(Image *dst, Font *font,
 
 	/* shorten text if necessary */
 	tr = ZR;
-	while(len > 0) {
-		tr = textextents_l(font, buf, len + min(shortened, 3), nil);
-		if(Dx(tr) <= width)
-			break;
-		while(len > 0 && (buf[--len]&0xC0) == 0x80)
-			buf[len] = '.';
-		buf[len] = '.';
-		shortened++;
+	if(len > 0) {
+		tr = textextents_l(font, buf, len, nil);
+		if(Dx(tr) > width)
+			len = shortenstring(font, buf, len, width, &tr);
 	}
 
 	if(len == 0 || Dx(tr) > width)
 		goto done;
 
-	/* mark shortened info in the string */
-	if(shortened)
-		len += min(shortened, 3);
-
 	switch (align) {
 	case East:
 		x = r.max.x - (tr.max.x + (font->height / 2));
@@ -627,11 +723,73 @@ copyimage(Image *dst, Rectangle r, Image *src, Point p) {
 }
 
 /* Colors */
+
+/* Every color string is looked up once and kept for good, so each
+ * costs at most one round trip, and #rrggbb strings on TrueColor
+ * visuals cost none. Strings which name no color are remembered,
+ * too, as badcolor.
+ */
+static MapEnt*	cbucket[137];
+static Map	colors = { cbucket, nelem(cbucket) };
+static MapEnt*	xbucket[137];
+static Map	xftcolors = { xbucket, nelem(xbucket) };
+static Color	badcolor;
+
+static bool
+parsehex(char *name, XRenderColor *c) {
+	ulong v;
+	int i;
+
+	if(name[0] != '#' || strlen(name) != 7)
+		return false;
+	for(i=1; i < 7; i++)
+		if(!isxdigit((uchar)name[i]))
+			return false;
+	v = strtoul(name+1, nil, 16);
+	c->red = ((v >> 16) & 0xff) * 0x101;
+	c->green = ((v >> 8) & 0xff) * 0x101;
+	c->blue = (v & 0xff) * 0x101;
+	c->alpha = 0xffff;
+	return true;
+}
+
+/* Scales a 16 bit channel into its place in a TrueColor pixel. */
+static ulong
+truepixel(ulong mask, ushort val) {
+	int shift, bits;
+
+	if(mask == 0)
+		return 0;
+	for(shift=0; !(mask & (1UL<<shift)); shift++)
+		;
+	for(bits=0; shift+bits < 32 && (mask & (1UL<<(shift+bits))); bits++)
+		;
+	return ((ulong)(val >> (16 - bits)) << shift) & mask;
+}
+
 bool
 namedcolor(char *name, Color *ret) {
 	XColor c, c2;
+	Color *col;
+	Visual *v;
+	void **e;
+
+	e = hash_get(&colors, name, false);
+	if(e) {
+		if(*e == &badcolor)
+			return false;
+		*ret = *(Color*)*e;
+		return true;
+	}
 
-	if(XAllocNamedColor(display, scr.colormap, name, &c, &c2)) {
+	v = scr.visual;
+	col = &badcolor;
+	if(v->class == TrueColor && parsehex(name, &ret->render)) {
+		ret->pixel = truepixel(v->red_mask, ret->render.red)
+			   | truepixel(v->green_mask, ret->render.green)
+			   | truepixel(v->blue_mask, ret->render.blue);
+		col = emalloc(sizeof *col);
+	}else if(XAllocNamedColor(display, scr.colormap, name, &c, &c2)) {
 		*ret = (Color) {
 			c.pixel, {
 				c.red,
@@ -640,9 +798,13 @@ namedcolor(char *name, Color *ret) {
 				0xffff
 			},
 		};
-		return true;
+		col = emalloc(sizeof *col);
 	}
-	return false;
+	if(col != &badcolor)
+		*col = *ret;
+	e = hash_get(&colors, estrdup(name), true);
+	*e = col;
+	return col != &badcolor;
 }
 
 bool
@@ -661,16 +823,20 @@ loadcolor(CTuple *c, char *str) {
 static XftColor*
 xftcolor(Color col) {
 	XftColor *c;
+	ulong pixel;
+	void **e;
 
-	c = emallocz(sizeof *c);
-	*c = (XftColor) {
-			  ((col.render.alpha&0xff00) << 24)
-			| ((col.render.red&0xff00) << 8)
-			| ((col.render.green&0xff00) << 0)
-			| ((col.render.blue&0xff00) >> 8),
-		col.render
-	};
-	return freelater(c);
+	pixel =   ((col.render.alpha&0xff00) << 24)
+		| ((col.render.red&0xff00) << 8)
+		| ((col.render.green&0xff00) << 0)
+		| ((col.render.blue&0xff00) >> 8);
+	e = map_get(&xftcolors, pixel, true);
+	if(*e == nil) {
+		c = emallocz(sizeof *c);
+		*c = (XftColor){ pixel, col.render };
+		*e = c;
+	}
+	return *e;
 }
 
 /* Fonts */
@@ -738,6 +904,8 @@ error:
 
 void
 freefont(Font *f) {
+	int i;
+
 	switch(f->type) {
 	case FFontSet:
 		XFreeFontSet(display, f->font.set);
@@ -751,6 +919,11 @@ freefont(Font *f) {
 	default:
 		break;
 	}
+	if(f->advance) {
+		for(i=0; i < 256; i++)
+			free(f->advance[i]);
+		free(f->advance);
+	}
 	free(f->name);
 	free(f);
 }
@@ -814,6 +987,30 @@ xatom(char *name) {
 	return (Atom)*e;
 }
 
+/* Interns those of the given atoms which aren't yet known, in a
+ * single round trip.
+ */
+void
+xatoms(char **names, int n) {
+	Atom *atoms;
+	char **unknown;
+	int i, m;
+
+	unknown = emalloc(n * sizeof *unknown);
+	m = 0;
+	for(i=0; i < n; i++)
+		if(hash_get(&atommap, names[i], false) == nil)
+			unknown[m++] = names[i];
+	if(m > 0) {
+		atoms = emalloc(m * sizeof *atoms);
+		if(XInternAtoms(display, unknown, m, false, atoms))
+			for(i=0; i < m; i++)
+				*hash_get(&atommap, unknown[i], true) = (void*)atoms[i];
+		free(atoms);
+	}
+	free(unknown);
+}
+
 void
 sendmessage(Window *w, char *name, long l0, long l1, long l2, long l3, long l4) {
 	XClientMessageEvent e;
@@ -888,14 +1085,211 @@ sync(void) {
 }
 
 /* Properties */
+void
+propcache_add(XWindow w, Atom prop, Atom type, int format, void *data, ulong nbytes) {
+	CachedProp *p;
+	void **e;
+
+	e = map_get(&propmap, w, true);
+	if(*e == nil) {
+		if(npropwins == propwinsize) {
+			propwinsize = max(propwinsize * 2, 16);
+			propwins = erealloc(propwins, propwinsize * sizeof *propwins);
+		}
+		propwins[npropwins++] = w;
+	}
+	p = emallocz(sizeof *p + nbytes + 1);
+	p->prop = prop;
+	p->type = type;
+	p->format = format;
+	p->nbytes = nbytes;
+	p->data = (uchar*)&p[1];
+	memcpy(p->data, data, nbytes);
+	p->next = *e;
+	*e = p;
+}
+
+void
+propcache_flush(void) {
+	CachedProp *p, *next;
+	int i;
+
+	for(i=0; i < npropwins; i++)
+		for(p=map_rm(&propmap, propwins[i]); p; p=next) {
+			next = p->next;
+			free(p);
+		}
+	npropwins = 0;
+}
+
+static CachedProp**
+propcache_find(XWindow w, Atom prop) {
+	CachedProp **pp;
+	void **e;
+
+	if(npropwins == 0)
+		return nil;
+	e = map_get(&propmap, w, false);
+	if(e == nil)
+		return nil;
+	for(pp=(CachedProp**)e; *pp; pp=&pp[0]->next)
+		if(pp[0]->prop == prop)
+			return pp;
+	return nil;
+}
+
+static void
+propcache_rm(XWindow w, Atom prop) {
+	CachedProp **pp, *p;
+
+	if((pp = propcache_find(w, prop))) {
+		p = *pp;
+		*pp = p->next;
+		free(p);
+	}
+}
+
+/* Emulates XGetWindowProperty on a cached value, including the
+ * expansion of 32 bit items to longs.
+ */
+static int
+propcache_get(CachedProp *p, Atom type, ulong offset, ulong length,
+	      Atom *actual, int *format, ulong *n, uchar **ret) {
+	ulong start, nbytes, i;
+	long *lp;
+	int size;
+
+	*actual = p->type;
+	*format = p->format;
+	*n = 0;
+	*ret = nil;
+	if(p->type == None || type != AnyPropertyType && type != p->type)
+		return Success;
+
+	start = 4 * offset;
+	if(start > p->nbytes)
+		return BadValue;
+	nbytes = min(p->nbytes - start, 4 * length);
+	size = p->format / 8;
+	*n = nbytes / size;
+
+	if(p->format == 32) {
+		lp = emalloc(*n * sizeof *lp + 1);
+		for(i=0; i < *n; i++)
+			lp[i] = ((int32_t*)(p->data + start))[i];
+		*ret = (uchar*)lp;
+	}else {
+		*ret = emalloc(nbytes + 1);
+		memcpy(*ret, p->data + start, nbytes);
+		(*ret)[nbytes] = '\0';
+	}
+	return Success;
+}
+
+/* The last value written by publish_long to each property, by window,
+ * so that unchanged values aren't sent to the server again. A count
+ * of -1 denotes a deleted property. Any other write drops the entry.
+ */
+typedef struct Published Published;
+struct Published {
+	Published*	next;
+	Atom		prop;
+	Atom		type;
+	int		n;
+	long*		data;
+};
+
+static MapEnt*	pubbucket[137];
+static Map	pubmap = { pubbucket, nelem(pubbucket) };
+
+static Published**
+published(XWindow w, Atom prop, bool create) {
+	Published **pp;
+	void **e;
+
+	e = map_get(&pubmap, w, create);
+	if(e == nil)
+		return nil;
+	for(pp=(Published**)e; *pp; pp=&(*pp)->next)
+		if((*pp)->prop == prop)
+			break;
+	return pp;
+}
+
+static void
+published_rm(XWindow w, Atom prop) {
+	Published **pp, *p;
+
+	pp = published(w, prop, false);
+	if(pp && (p = *pp)) {
+		*pp = p->next;
+		free(p->data);
+		free(p);
+	}
+}
+
+/* Like changeprop_long, or delproperty when n is -1, but only if the
+ * value differs from the one last published.
+ */
+void
+publish_long(Window *w, char *prop, char *type, long data[], int n) {
+	Published **pp, *p;
+	Atom atom, typea;
+
+	atom = xatom(prop);
+	typea = type ? xatom(type) : None;
+	pp = published(w->xid, atom, true);
+	p = *pp;
+	if(p && p->type == typea && p->n == n
+	&& (n <= 0 || !memcmp(p->data, data, n * sizeof *data)))
+		return;
+
+	if(p == nil) {
+		p = emallocz(sizeof *p);
+		p->prop = atom;
+		*pp = p;
+	}
+	p->type = typea;
+	p->n = n;
+	free(p->data);
+	p->data = nil;
+	if(n > 0) {
+		p->data = emalloc(n * sizeof *data);
+		memcpy(p->data, data, n * sizeof *data);
+	}
+
+	propcache_rm(w->xid, atom);
+	if(n < 0)
+		XDeleteProperty(display, w->xid, atom);
+	else
+		XChangeProperty(display, w->xid, atom, typea, 32,
+				PropModeReplace, (uchar*)data, n);
+}
+
+/* Forgets everything published on w. */
+void
+unpublish(Window *w) {
+	Published *p, *next;
+
+	for(p=map_rm(&pubmap, w->xid); p; p=next) {
+		next = p->next;
+		free(p->data);
+		free(p);
+	}
+}
+
 void
 delproperty(Window *w, char *prop) {
+	propcache_rm(w->xid, xatom(prop));
+	published_rm(w->xid, xatom(prop));
 	XDeleteProperty(display, w->xid, xatom(prop));
 }
 
 void
 changeproperty(Window *w, char *prop, char *type,
 	       int width, uchar data[], int n) {
+	propcache_rm(w->xid, xatom(prop));
+	published_rm(w->xid, xatom(prop));
 	XChangeProperty(display, w->xid, xatom(prop), xatom(type), width,
 			PropModeReplace, data, n);
 }
@@ -952,15 +1346,20 @@ freestringlist(char *list[]) {
 static ulong
 getprop(Window *w, char *prop, char *type, Atom *actual, int *format,
 	ulong offset, uchar **ret, ulong length) {
+	CachedProp **pp;
 	Atom typea;
 	ulong n, extra;
 	int status;
 
 	typea = (type ? xatom(type) : 0L);
 
-	status = XGetWindowProperty(display, w->xid,
-		xatom(prop), offset, length, false /* delete */,
-		typea, actual, format, &n, &extra, ret);
+	if((pp = propcache_find(w->xid, xatom(prop))))
+		status = propcache_get(*pp, typea, offset, length,
+				       actual, format, &n, ret);
+	else
+		status = XGetWindowProperty(display, w->xid,
+			xatom(prop), offset, length, false /* delete */,
+			typea, actual, format, &n, &extra, ret);
 
 	if(status != Success) {
 		*ret = nil;
@@ -1035,7 +1434,8 @@ getprop_textlist(Window *w, char *name, char **ret[]) {
 	*ret = nil;
 	n = 0;
 
-	XGetTextProperty(display, w->xid, &prop, xatom(name));
+	prop.nitems = getprop(w, name, nil, &prop.encoding, &prop.format,
+			      0L, &prop.value, 1L<<20);
 	if(prop.nitems > 0) {
 		if(Xutf8TextPropertyToTextList(display, &prop, &list, &n) == Success)
 			*ret = list;
@@ -1166,6 +1566,73 @@ ungrabkeyboard(void) {
 	XUngrabKeyboard(display, CurrentTime);
 }
 
+/* The equivalents of XGetWMHints and XGetWMNormalHints, but through
+ * getprop, so that they may be served from the property cache.
+ */
+XWMHints*
+getprop_wmhints(Window *w) {
+	XWMHints *h;
+	long *l;
+	ulong n;
+
+	n = getprop_long(w, "WM_HINTS", "WM_HINTS", 0L, &l, 9L);
+	if(n < 8) {
+		free(l);
+		return nil;
+	}
+	h = emallocz(sizeof *h);
+	h->flags = l[0];
+	h->input = l[1];
+	h->initial_state = l[2];
+	h->icon_pixmap = l[3];
+	h->icon_window = l[4];
+	h->icon_x = l[5];
+	h->icon_y = l[6];
+	h->icon_mask = l[7];
+	if(n > 8)
+		h->window_group = l[8];
+	else
+		h->flags &= ~WindowGroupHint;
+	free(l);
+	return h;
+}
+
+static bool
+getprop_sizehints(Window *w, XSizeHints *xs) {
+	long *l;
+	ulong n;
+
+	n = getprop_long(w, "WM_NORMAL_HINTS", "WM_SIZE_HINTS", 0L, &l, 18L);
+	if(n < 15) {
+		free(l);
+		return false;
+	}
+	memset(xs, 0, sizeof *xs);
+	xs->flags = l[0];
+	xs->x = l[1];
+	xs->y = l[2];
+	xs->width = l[3];
+	xs->height = l[4];
+	xs->min_width = l[5];
+	xs->min_height = l[6];
+	xs->max_width = l[7];
+	xs->max_height = l[8];
+	xs->width_inc = l[9];
+	xs->height_inc = l[10];
+	xs->min_aspect.x = l[11];
+	xs->min_aspect.y = l[12];
+	xs->max_aspect.x = l[13];
+	xs->max_aspect.y = l[14];
+	if(n >= 18) {
+		xs->base_width = l[15];
+		xs->base_height = l[16];
+		xs->win_gravity = l[17];
+	}else
+		xs->flags &= ~(PBaseSize|PWinGravity);
+	free(l);
+	return true;
+}
+
 /* Insanity */
 void
 sethints(Window *w) {
@@ -1173,7 +1640,6 @@ sethints(Window *w) {
 	XWMHints *wmh;
 	WinHints *h;
 	Point p;
-	long size;
 
 	if(w->hints == nil)
 		w->hints = emalloc(sizeof *h);
@@ -1184,14 +1650,14 @@ sethints(Window *w) {
 	h->max = Pt(INT_MAX, INT_MAX);
 	h->inc = Pt(1,1);
 
-	wmh = XGetWMHints(display, w->xid);
+	wmh = getprop_wmhints(w);
 	if(wmh) {
 		if(wmh->flags & WindowGroupHint)
 			h->group = wmh->window_group;
 		free(wmh);
 	}
 
-	if(!XGetWMNormalHints(display, w->xid, &xs, &size))
+	if(!getprop_sizehints(w, &xs))
 		return;
 
 	if(xs.flags & PMinSize) {
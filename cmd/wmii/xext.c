@@ -13,6 +13,7 @@
 
 static void	randr_screenchange(XRRScreenChangeNotifyEvent*);
 static bool	randr_event_p(XEvent *e);
+static void	randr_getrefresh(void);
 static void	randr_init(void);
 static void	render_init(void);
 static void	xinerama_init(void);
@@ -24,6 +25,7 @@ bool	have_RandR;
 bool	have_render;
 bool	have_xinerama;
 int	randr_eventbase;
+static int	refresh;
 
 static void
 handle(XEvent *e, EvHandler h[], int base) {
@@ -56,6 +58,27 @@ randr_init(void) {
 			have_RandR = false;
 	if(have_RandR)
 		XRRSelectInput(display, scr.root.xid, RRScreenChangeNotifyMask);
+	randr_getrefresh();
+}
+
+static void
+randr_getrefresh(void) {
+	XRRScreenConfiguration *c;
+
+	refresh = 0;
+	if(!have_RandR)
+		return;
+	c = XRRGetScreenInfo(display, scr.root.xid);
+	if(c) {
+		refresh = XRRConfigCurrentRate(c);
+		XRRFreeScreenConfigInfo(c);
+	}
+}
+
+/* Returns the screen's refresh rate, in Hz, or 0 if it isn't known. */
+int
+randr_refresh(void) {
+	return refresh;
 }
 
 static bool
@@ -72,6 +95,7 @@ randr_screenchange(XRRScreenChangeNotifyEvent *ev) {
 		scr.rect = Rect(0, 0, ev->width, ev->height);
 	else
 		scr.rect = Rect(0, 0, ev->height, ev->width);
+	randr_getrefresh();
 	init_screens();
 }
 
@@ -3,6 +3,7 @@
  */
 #define IXP_NO_P9_
 #define IXP_P9_STRUCTS
+#include <fcntl.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,6 +11,7 @@
 #include <unistd.h>
 #include <ixp.h>
 #include <util.h>
+#include <bio.h>
 #include <fmt.h>
 
 static IxpClient *client;
@@ -17,9 +19,10 @@ static IxpClient *client;
 static void
 usage(void) {
 	fprint(1,
-	       "usage: %s [-a <address>] {create | ls [-dlp] | read | remove | write} <file>\n"
+	       "usage: %s [-a <address>] {create | ls [-dlp] | read [-f <filter>] | remove | write} <file>\n"
 	       "       %s [-a <address>] xwrite <file> <data>\n"
-	       "       %s -v\n", argv0, argv0, argv0);
+	       "       %s [-a <address>] -s\n"
+	       "       %s -v\n", argv0, argv0, argv0, argv0);
 	exit(1);
 }
 
@@ -88,7 +91,7 @@ timestr(time_t val) {
 }
 
 static void
-print_stat(Stat *s, int lflag, char *file, int pflag) {
+print_stat(Fmt *f, Stat *s, int lflag, char *file, int pflag) {
 	char *slash;
 
 	slash = "";
@@ -98,17 +101,78 @@ print_stat(Stat *s, int lflag, char *file, int pflag) {
 		file = "";
 
 	if(lflag)
-		print("%s %s %s %5llud %s %s%s%s\n",
+		fmtprint(f, "%s %s %s %5llud %s %s%s%s\n",
 				modestr(s->mode), s->uid, s->gid, s->length,
 				timestr(s->mtime), file, slash, s->name);
 	else {
 		if((s->mode&P9_DMDIR) && strcmp(s->name, "/"))
-			print("%s%s%s/\n", file, slash, s->name);
+			fmtprint(f, "%s%s%s/\n", file, slash, s->name);
 		else
-			print("%s%s%s\n", file, slash, s->name);
+			fmtprint(f, "%s%s%s\n", file, slash, s->name);
 	}
 }
 
+/* Lists file into f. Returns -1 and leaves the error in errstr if
+ * it can't be stat'd or read.
+ */
+static int
+list(Fmt *f, char *file, int lflag, int dflag, int pflag) {
+	IxpMsg m;
+	Stat *stat;
+	IxpCFid *fid;
+	char *buf;
+	int count, nstat, mstat, i;
+
+	stat = ixp_stat(client, file);
+	if(stat == nil)
+		return -1;
+
+	i = strlen(file);
+	if(file[i-1] == '/') {
+		file[i-1] = '\0';
+		if(!(stat->mode&P9_DMDIR)) {
+			ixp_freestat(stat);
+			ixp_werrstr("not a directory");
+			return -1;
+		}
+	}
+	if(dflag || (stat->mode&P9_DMDIR) == 0) {
+		print_stat(f, stat, lflag, file, pflag);
+		ixp_freestat(stat);
+		return 0;
+	}
+	ixp_freestat(stat);
+
+	fid = ixp_open(client, file, P9_OREAD);
+	if(fid == nil)
+		return -1;
+
+	nstat = 0;
+	mstat = 16;
+	stat = emalloc(mstat * sizeof *stat);
+	buf = emalloc(fid->iounit);
+	while((count = ixp_read(fid, buf, fid->iounit)) > 0) {
+		m = ixp_message(buf, count, MsgUnpack);
+		while(m.pos < m.end) {
+			if(nstat == mstat) {
+				mstat <<= 1;
+				stat = erealloc(stat, mstat * sizeof *stat);
+			}
+			ixp_pstat(&m, &stat[nstat++]);
+		}
+	}
+	ixp_close(fid);
+	free(buf);
+
+	qsort(stat, nstat, sizeof *stat, comp_stat);
+	for(i = 0; i < nstat; i++) {
+		print_stat(f, &stat[i], lflag, file, pflag);
+		ixp_freestat(&stat[i]);
+	}
+	free(stat);
+	return count;
+}
+
 /* Service Functions */
 static int
 xwrite(int argc, char *argv[]) {
@@ -205,10 +269,14 @@ xremove(int argc, char *argv[]) {
 static int
 xread(int argc, char *argv[]) {
 	IxpCFid *fid;
-	char *file, *buf;
+	char *file, *buf, *filter;
 	int count;
 
+	filter = nil;
 	ARGBEGIN{
+	case 'f':
+		filter = EARGF(usage());
+		break;
 	default:
 		usage();
 	}ARGEND;
@@ -217,9 +285,15 @@ xread(int argc, char *argv[]) {
 		usage();
 	file = EARGF(usage());
 	do {
-		fid = ixp_open(client, file, P9_OREAD);
+		fid = ixp_open(client, file, filter ? P9_ORDWR : P9_OREAD);
 		if(fid == nil)
 			fatal("Can't open file '%s': %r\n", file);
+		if(filter) {
+			buf = smprint("filter %s", filter);
+			if(ixp_write(fid, buf, strlen(buf)) == -1)
+				fatal("Can't set filter on '%s': %r\n", file);
+			free(buf);
+		}
 
 		buf = emalloc(fid->iounit);
 		while((count = ixp_read(fid, buf, fid->iounit)) > 0)
@@ -235,13 +309,10 @@ xread(int argc, char *argv[]) {
 
 static int
 xls(int argc, char *argv[]) {
-	IxpMsg m;
-	Stat *stat;
-	IxpCFid *fid;
+	Fmt f;
+	char buf[1024];
 	char *file;
-	char *buf;
 	int lflag, dflag, pflag;
-	int count, nstat, mstat, i;
 
 	lflag = dflag = pflag = 0;
 
@@ -259,56 +330,15 @@ xls(int argc, char *argv[]) {
 		usage();
 	}ARGEND;
 
-	count = 0;
+	fmtfdinit(&f, 1, buf, sizeof buf);
 	file = EARGF(usage());
 	do {
-		stat = ixp_stat(client, file);
-		if(stat == nil)
-			fatal("cannot stat file '%s': %r\n", file);
-
-		i = strlen(file);
-		if(file[i-1] == '/') {
-			file[i-1] = '\0';
-			if(!(stat->mode&P9_DMDIR))
-				fatal("%s: not a directory", file);
-		}
-		if(dflag || (stat->mode&P9_DMDIR) == 0) {
-			print_stat(stat, lflag, file, pflag);
-			ixp_freestat(stat);
-			continue;
-		}
-		ixp_freestat(stat);
-
-		fid = ixp_open(client, file, P9_OREAD);
-		if(fid == nil)
-			fatal("Can't open file '%s': %r\n", file);
-
-		nstat = 0;
-		mstat = 16;
-		stat = emalloc(mstat * sizeof *stat);
-		buf = emalloc(fid->iounit);
-		while((count = ixp_read(fid, buf, fid->iounit)) > 0) {
-			m = ixp_message(buf, count, MsgUnpack);
-			while(m.pos < m.end) {
-				if(nstat == mstat) {
-					mstat <<= 1;
-					stat = erealloc(stat, mstat * sizeof *stat);
-				}
-				ixp_pstat(&m, &stat[nstat++]);
-			}
-		}
-		ixp_close(fid);
-
-		qsort(stat, nstat, sizeof *stat, comp_stat);
-		for(i = 0; i < nstat; i++) {
-			print_stat(&stat[i], lflag, file, pflag);
-			ixp_freestat(&stat[i]);
+		if(list(&f, file, lflag, dflag, pflag) == -1) {
+			fmtfdflush(&f);
+			fatal("cannot list '%s': %r\n", file);
 		}
-		free(stat);
 	} while((file = ARGF()));
-
-	if(count == -1)
-		fatal("cannot read directory '%s': %r\n", file);
+	fmtfdflush(&f);
 	return 0;
 }
 
@@ -351,6 +381,259 @@ xsetsid(int argc, char *argv[]) {
 	return 1; /* NOTREACHED */
 }
 
+/* Coprocess Mode
+ *
+ * With -s, wmiir stays mounted and reads one command per line from
+ * its standard input:
+ *
+ *	create <file> [<n>]
+ *	ls [-dlp] <path>
+ *	read <file>
+ *	remove <path>
+ *	write <file> <n>
+ *	xwrite <file> <data>
+ *
+ * create and write are followed by <n> bytes of raw data. Each
+ * command is answered with either "ok <n>" followed by <n> bytes of
+ * output, or "error <message>", each on its own line.
+ */
+typedef struct Reply Reply;
+struct Reply {
+	char*	data;
+	long	n;
+	long	size;
+};
+
+static void
+reply(Reply *r, void *data, long n) {
+	if(r->n + n > r->size) {
+		if(r->size == 0)
+			r->size = 4096;
+		while(r->n + n > r->size)
+			r->size <<= 1;
+		r->data = erealloc(r->data, r->size);
+	}
+	memcpy(r->data + r->n, data, n);
+	r->n += n;
+}
+
+static char*
+nextarg(char *s) {
+	s += strcspn(s, " \t");
+	if(*s)
+		*s++ = '\0';
+	return s + strspn(s, " \t");
+}
+
+static char*
+readdata(Biobuf *in, char *arg, long *np) {
+	char *buf, *end;
+	long n;
+
+	n = strtol(arg, &end, 10);
+	if(end == arg || *end != '\0' || n < 0) {
+		ixp_werrstr("bad byte count: '%s'", arg);
+		return nil;
+	}
+	buf = emalloc(n + 1);
+	if(Bread(in, buf, n) != n)
+		fatal("short input\n");
+	*np = n;
+	return buf;
+}
+
+static int
+s_create(Reply *r, char *file, char *arg, Biobuf *in) {
+	IxpCFid *fid;
+	char *buf;
+	long n;
+	int ret;
+
+	USED(r);
+	buf = nil;
+	n = 0;
+	if(*arg) {
+		buf = readdata(in, arg, &n);
+		if(buf == nil)
+			return -1;
+	}
+
+	ret = -1;
+	fid = ixp_create(client, file, 0777, P9_OWRITE);
+	if(fid) {
+		ret = 0;
+		if(n > 0 && (fid->qid.type&P9_DMDIR) == 0)
+		if(ixp_write(fid, buf, n) != n)
+			ret = -1;
+		ixp_close(fid);
+	}
+	free(buf);
+	return ret;
+}
+
+static int
+s_ls(Reply *r, char *file, char *arg, Biobuf *in) {
+	Fmt f;
+	char *s;
+	int lflag, dflag, pflag;
+	int ret;
+
+	USED(in);
+	lflag = dflag = pflag = 0;
+	while(file[0] == '-') {
+		for(s=file+1; *s; s++)
+			switch(*s) {
+			case 'd': dflag++; break;
+			case 'l': lflag++; break;
+			case 'p': pflag++; break;
+			default:
+				ixp_werrstr("bad flag: %c", *s);
+				return -1;
+			}
+		file = arg;
+		arg = nextarg(file);
+	}
+	if(*file == '\0') {
+		ixp_werrstr("no path");
+		return -1;
+	}
+
+	fmtstrinit(&f);
+	ret = list(&f, file, lflag, dflag, pflag);
+	s = fmtstrflush(&f);
+	reply(r, s, strlen(s));
+	free(s);
+	return ret;
+}
+
+static int
+s_read(Reply *r, char *file, char *arg, Biobuf *in) {
+	IxpCFid *fid;
+	char *buf;
+	int count;
+
+	USED(arg, in);
+	fid = ixp_open(client, file, P9_OREAD);
+	if(fid == nil)
+		return -1;
+
+	buf = emalloc(fid->iounit);
+	while((count = ixp_read(fid, buf, fid->iounit)) > 0)
+		reply(r, buf, count);
+	ixp_close(fid);
+	free(buf);
+	return count;
+}
+
+static int
+s_remove(Reply *r, char *file, char *arg, Biobuf *in) {
+
+	USED(r, arg, in);
+	return ixp_remove(client, file) ? 0 : -1;
+}
+
+static int
+s_write(Reply *r, char *file, char *arg, Biobuf *in) {
+	IxpCFid *fid;
+	char *buf;
+	long n;
+	int ret;
+
+	USED(r);
+	buf = readdata(in, arg, &n);
+	if(buf == nil)
+		return -1;
+
+	ret = -1;
+	fid = ixp_open(client, file, P9_OWRITE);
+	if(fid) {
+		if(ixp_write(fid, buf, n) == n)
+			ret = 0;
+		ixp_close(fid);
+	}
+	free(buf);
+	return ret;
+}
+
+static int
+s_xwrite(Reply *r, char *file, char *arg, Biobuf *in) {
+	IxpCFid *fid;
+	int n, ret;
+
+	USED(r, in);
+	fid = ixp_open(client, file, P9_OWRITE);
+	if(fid == nil)
+		return -1;
+
+	n = strlen(arg);
+	ret = ixp_write(fid, arg, n) == n ? 0 : -1;
+	ixp_close(fid);
+	return ret;
+}
+
+typedef struct servetab servetab;
+struct servetab {
+	char *cmd;
+	int (*fn)(Reply*, char*, char*, Biobuf*);
+} srvtab[] = {
+	{"cat", s_read},
+	{"create", s_create},
+	{"ls", s_ls},
+	{"read", s_read},
+	{"remove", s_remove},
+	{"rm", s_remove},
+	{"write", s_write},
+	{"xwrite", s_xwrite},
+	{0, }
+};
+
+static int
+serve(void) {
+	Biobuf in;
+	Reply r;
+	servetab *tab;
+	char *line, *cmd, *file, *arg, *err, *p;
+	int ret;
+
+	Binit(&in, 0, O_RDONLY);
+	memset(&r, 0, sizeof r);
+	while((line = Brdstr(&in, '\n', 1))) {
+		cmd = line + strspn(line, " \t");
+		file = nextarg(cmd);
+		arg = nextarg(file);
+
+		r.n = 0;
+		for(tab=srvtab; tab->cmd; tab++)
+			if(!strcmp(cmd, tab->cmd))
+				break;
+		if(tab->cmd == nil) {
+			ixp_werrstr("unknown command: %s", cmd);
+			ret = -1;
+		}else if(*file == '\0') {
+			ixp_werrstr("no file");
+			ret = -1;
+		}else
+			ret = tab->fn(&r, file, arg, &in);
+
+		if(ret == -1) {
+			/* Keep the reply to a single line. */
+			err = smprint("%r");
+			for(p=err; *p; p++)
+				if(*p == '\n')
+					*p = ' ';
+			print("error %s\n", err);
+			free(err);
+		}else {
+			print("ok %ld\n", r.n);
+			write(1, r.data, r.n);
+		}
+		free(line);
+	}
+	Bterm(&in);
+	free(r.data);
+	return 0;
+}
+
 typedef struct exectab exectab;
 struct exectab {
 	char *cmd;
@@ -376,13 +659,14 @@ int
 main(int argc, char *argv[]) {
 	char *address;
 	exectab *tab;
-	int ret;
+	int ret, sflag;
 
 	quotefmtinstall();
 	fmtinstall('r', errfmt);
 
 	address = getenv("WMII_ADDRESS");
 
+	sflag = 0;
 	ARGBEGIN{
 	case 'v':
 		print("%s-" VERSION ", " COPYRIGHT "\n", argv0);
@@ -390,16 +674,21 @@ main(int argc, char *argv[]) {
 	case 'a':
 		address = EARGF(usage());
 		break;
+	case 's':
+		sflag++;
+		break;
 	default:
 		usage();
 	}ARGEND;
 
-	if(argc < 1)
+	if(argc < 1 && !sflag)
 		usage();
 
-	for(tab=utiltab; tab->cmd; tab++)
-		if(!strcmp(*argv, tab->cmd))
-			return tab->fn(argc, argv);
+	if(!sflag) {
+		for(tab=utiltab; tab->cmd; tab++)
+			if(!strcmp(*argv, tab->cmd))
+				return tab->fn(argc, argv);
+	}
 
 	if(address && *address)
 		client = ixp_mount(address);
@@ -408,6 +697,12 @@ main(int argc, char *argv[]) {
 	if(client == nil)
 		fatal("can't mount: %r\n");
 
+	if(sflag) {
+		ret = serve();
+		ixp_unmount(client);
+		return ret;
+	}
+
 	for(tab=fstab; tab->cmd; tab++)
 		if(strcmp(*argv, tab->cmd) == 0) break;
 	if(tab->cmd == 0)
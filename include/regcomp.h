@@ -69,3 +69,44 @@ extern Relist*	_renewthread(Relist*, Reinst*, int, Resublist*);
 extern void	_renewmatch(Resub*, int, Resublist*);
 extern Relist*	_renewemptythread(Relist*, Reinst*, int, char*);
 extern Relist*	_rrenewemptythread(Relist*, Reinst*, int, Rune*);
+
+/*
+ *  pattern sets (regset.c)
+ */
+typedef struct Dstate	Dstate;
+struct	Reset
+{
+	int	n;		/* number of programs */
+	Reinst*	inst;		/* their instructions, end to end */
+	int	ninst;
+	Reclass*	class;
+	int*	prog;		/* program of each instruction */
+	Reinst**	start;		/* start instruction of each program */
+	int*	starts;		/* program numbers, split into: */
+	int*	byrune[Runeself];	/*  those starting with a rune */
+	int	nbyrune[Runeself];
+	int*	bol;		/*  those anchored with ^ */
+	int	nbol;
+	int*	any;		/*  and the rest */
+	int	nany;
+	Reinst**	list[2];	/* run lists */
+	uint*	mark;		/* generation each instruction was last listed in */
+	uint	gen;
+
+	/* lazy DFA (regdfa.c) */
+	uchar	cls[Runeself];	/* class of each ASCII rune */
+	int	ncls;
+	Dstate**	dhash;
+	Dstate*	dinit;
+	long	dmem;
+	long	dmaxmem;
+	uint	dflush;		/* times the states have been thrown away */
+	Rune	skip;		/* the rune every match must start with */
+};
+
+extern int	_resetstep(Reset*, Reinst**, int, Reinst**, int*, Rune, int, int, uint);
+extern uint	_resetgen(Reset*, int);
+extern void	_regdfainit(Reset*);
+extern void	_regdfafree(Reset*);
+extern int	_regdfaexec(Reset*, char*, Rune*);
+extern int	_regexecdfa(Reprog*, char*, Rune*);
@@ -11,6 +11,7 @@ typedef struct Resub		Resub;
 typedef struct Reclass		Reclass;
 typedef struct Reinst		Reinst;
 typedef struct Reprog		Reprog;
+typedef struct Reset		Reset;
 
 /*
  *	Sub expression matches
@@ -56,6 +57,7 @@ struct Reinst{
  */
 struct Reprog{
 	Reinst	*startinst;	/* start pc */
+	Reset	*set;		/* DFA, built by regexec when it's not asked for matches */
 	Reclass	class[32];	/* .data */
 	Reinst	firstinst[5];	/* .text */
 };
@@ -64,12 +66,17 @@ extern Reprog	*regcomp9(char*);
 extern Reprog	*regcomplit9(char*);
 extern Reprog	*regcompnl9(char*);
 extern void	regerror9(char*);
+extern void	regfree9(Reprog*);
 extern int	regexec9(Reprog*, char*, Resub*, int);
 extern void	regsub9(char*, char*, int, Resub*, int);
 
 extern int	rregexec9(Reprog*, Rune*, Resub*, int);
 extern void	rregsub9(Rune*, Rune*, int, Resub*, int);
 
+extern Reset	*regcompset9(Reprog**, int);
+extern int	regexecset9(Reset*, char*);
+extern void	regfreeset9(Reset*);
+
 /*
  * Darwin simply cannot handle having routines that
  * override other library routines.
@@ -79,10 +86,14 @@ extern void	rregsub9(Rune*, Rune*, int, Resub*, int);
 #define regcomplit regcomplit9
 #define regcompnl regcompnl9
 #define regerror regerror9
+#define regfree regfree9
 #define regexec regexec9
 #define regsub regsub9
 #define rregexec rregexec9
 #define rregsub rregsub9
+#define regcompset regcompset9
+#define regexecset regexecset9
+#define regfreeset regfreeset9
 #endif
 
 #endif
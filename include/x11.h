@@ -103,6 +103,7 @@ struct Font {
 	int	descent;
 	uint	height;
 	char*	name;
+	short**	advance; /* Glyph advances by rune, filled lazily */
 };
 
 struct Handlers {
@@ -188,6 +189,7 @@ Screen scr;
 extern const Point ZP;
 extern const Rectangle ZR;
 extern Window* pointerwin;
+extern bool glyphcache;
 
 Point Pt(int x, int y);
 Rectangle Rect(int x0, int y0, int x1, int y1);
@@ -238,6 +240,7 @@ ulong	getprop_long(Window*, char*, char*, ulong, long**, ulong);
 char*	getprop_string(Window*, char*);
 int	getprop_textlist(Window *w, char *name, char **ret[]);
 ulong	getprop_ulong(Window*, char*, char*, ulong, ulong**, ulong);
+XWMHints*	getprop_wmhints(Window*);
 ulong	getproperty(Window*, char *prop, char *type, Atom *actual, ulong offset, uchar **ret, ulong length);
 int	grabkeyboard(Window*);
 int	grabpointer(Window*, Window *confine, Cursor, int mask);
@@ -253,6 +256,9 @@ Point	mulpt(Point p, Point q);
 bool	namedcolor(char *name, Color*);
 bool	parsekey(char*, int*, char**);
 int	pointerscreen(void);
+void	propcache_add(XWindow, Atom, Atom type, int format, void*, ulong);
+void	propcache_flush(void);
+void	publish_long(Window*, char*, char*, long[], int);
 Point	querypointer(Window*);
 void	raisewin(Window*);
 void	reparentwindow(Window*, Window*, Point);
@@ -275,10 +281,12 @@ Point	translate(Window*, Window*, Point);
 void	ungrabkeyboard(void);
 void	ungrabpointer(void);
 int	unmapwin(Window*);
+void	unpublish(Window*);
 void	warppointer(Point);
 Window*	window(XWindow);
 long	winprotocols(Window*);
 Atom	xatom(char*);
+void	xatoms(char**, int);
 void	sendmessage(Window*, char*, long, long, long, long, long);
 XRectangle	XRect(Rectangle);
 Rectangle	getwinrect(Window*);
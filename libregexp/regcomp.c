@@ -484,6 +484,7 @@ regcomp1(char *s, int literal, int dot_type)
 		regerror("out of memory");
 		return 0;
 	}
+	pp->set = 0;
 	freep = pp->firstinst;
 	classp = pp->class;
 	errors = 0;
@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include "plan9.h"
+#include "regexp9.h"
+#include "regcomp.h"
+
+/*
+ *  A lazily built DFA over a pattern set.  Each state stands
+ *  for the threads the NFA in regset.c would be running, whether
+ *  the last rune ended a line, and the best match so far.  Its
+ *  transitions are worked out by that NFA the first time they're
+ *  taken, and cached for ASCII runes in a table indexed by rune
+ *  class: runes which no instruction tells apart share a class.
+ *  When the states outgrow their budget they are all thrown away
+ *  and the DFA is built afresh.
+ */
+
+enum {
+	Dbol	= 1,	/* the next rune begins a line */
+	NDHASH	= 256,
+	DFAMEM	= 1<<15,	/* bytes of states for any set */
+	DFAPROG	= 1<<10,	/* and for each program in it */
+};
+
+struct Dstate
+{
+	Dstate*	link;		/* hash chain */
+	uint	hash;
+	int	flags;
+	int	best;		/* best program matched so far */
+	int	n;
+	Reinst**	inst;		/* threads, sorted */
+	Dstate*	next[1];	/* by rune class */
+};
+
+static void
+boundary(uchar *cut, long r)
+{
+	if(r >= 0 && r < Runeself)
+		cut[r] = 1;
+}
+
+extern void
+_regdfainit(Reset *rs)
+{
+	uchar cut[Runeself];
+	Reinst *inst;
+	Rune *rp;
+	int i, c;
+
+	memset(cut, 0, sizeof cut);
+	boundary(cut, 1);
+	boundary(cut, '\n');
+	boundary(cut, '\n'+1);
+	for(inst=rs->inst; inst<rs->inst+rs->ninst; inst++)
+		switch(inst->type){
+		case RUNE:
+			boundary(cut, inst->u1.r);
+			boundary(cut, inst->u1.r+1);
+			break;
+		case CCLASS:
+		case NCCLASS:
+			for(rp=inst->u1.cp->spans; rp<inst->u1.cp->end; rp+=2){
+				boundary(cut, rp[0]);
+				boundary(cut, rp[1]+1);
+			}
+			break;
+		}
+	c = 0;
+	for(i=0; i<Runeself; i++){
+		c += cut[i];
+		rs->cls[i] = c;
+	}
+	rs->ncls = c+1;
+	rs->dmaxmem = DFAMEM + rs->n*DFAPROG;
+
+	/*
+	 *  If every program starts with the same rune, or at
+	 *  the start of a line, there's no need to step through
+	 *  the runes before it while nothing is running.
+	 */
+	rs->skip = 0;
+	if(rs->nany == 0 && rs->nbol == 0){
+		for(i=0; i<Runeself; i++)
+			if(rs->nbyrune[i]){
+				if(rs->skip)
+					break;
+				rs->skip = i;
+			}
+		if(i < Runeself)
+			rs->skip = 0;
+	}else if(rs->nany == 0 && rs->nbol == rs->n)
+		rs->skip = '\n';
+}
+
+static void
+flush(Reset *rs)
+{
+	Dstate *d, *next;
+	int i;
+
+	if(rs->dhash == nil)
+		return;
+	for(i=0; i<NDHASH; i++)
+		for(d=rs->dhash[i]; d; d=next){
+			next = d->link;
+			free(d);
+		}
+	memset(rs->dhash, 0, NDHASH * sizeof *rs->dhash);
+	rs->dinit = nil;
+	rs->dmem = 0;
+	rs->dflush++;
+}
+
+extern void
+_regdfafree(Reset *rs)
+{
+	flush(rs);
+	free(rs->dhash);
+}
+
+static int
+instcmp(const void *a, const void *b)
+{
+	Reinst *x, *y;
+
+	x = *(Reinst**)a;
+	y = *(Reinst**)b;
+	return x < y ? -1 : x > y;
+}
+
+/*
+ *  Returns the state for the given threads, making it
+ *  if need be, or 0 if there's no memory for it.
+ */
+static Dstate*
+intern(Reset *rs, Reinst **inst, int n, int flags, int best)
+{
+	Dstate *d;
+	uint h;
+	long size;
+	int i;
+
+	qsort(inst, n, sizeof *inst, instcmp);
+	h = flags*31 + best;
+	for(i=0; i<n; i++)
+		h = h*31 + (inst[i] - rs->inst);
+
+	if(rs->dhash == nil){
+		rs->dhash = calloc(NDHASH, sizeof *rs->dhash);
+		if(rs->dhash == nil)
+			return 0;
+	}
+	for(d=rs->dhash[h%NDHASH]; d; d=d->link)
+		if(d->hash == h && d->flags == flags && d->best == best && d->n == n
+		&& memcmp(d->inst, inst, n * sizeof *inst) == 0)
+			return d;
+
+	size = sizeof *d + (rs->ncls-1) * sizeof d->next[0] + n * sizeof *inst;
+	if(rs->dmem + size > rs->dmaxmem)
+		flush(rs);
+	d = calloc(1, size);
+	if(d == 0)
+		return 0;
+	rs->dmem += size;
+	d->hash = h;
+	d->flags = flags;
+	d->best = best;
+	d->n = n;
+	d->inst = (Reinst**)&d->next[rs->ncls];
+	memcpy(d->inst, inst, n * sizeof *inst);
+	d->link = rs->dhash[h%NDHASH];
+	rs->dhash[h%NDHASH] = d;
+	return d;
+}
+
+/*
+ *  Works out where d goes on r, and remembers it.
+ */
+static Dstate*
+step(Reset *rs, Dstate *d, Rune r)
+{
+	Dstate *nd;
+	Reinst **tl, **nl;
+	uint gen, nflush;
+	int i, best, nnl;
+
+	tl = rs->list[0];
+	nl = rs->list[1];
+	gen = _resetgen(rs, 2);
+	for(i=0; i<d->n; i++){
+		tl[i] = d->inst[i];
+		rs->mark[tl[i] - rs->inst] = gen;
+	}
+	nnl = 0;
+	best = _resetstep(rs, tl, d->n, nl, &nnl, r, d->flags&Dbol, d->best, gen);
+
+	nflush = rs->dflush;
+	nd = intern(rs, nl, nnl, r == '\n' ? Dbol : 0, best);
+	/* d is gone if the cache was flushed. */
+	if(nd && r < Runeself && rs->dflush == nflush)
+		d->next[rs->cls[r]] = nd;
+	return nd;
+}
+
+/*
+ *  Runs the DFA over s, or if it's nil, over the runes in rs.
+ *  Returns the number of the first program to match, rs->n if
+ *  none does, or -2 if the DFA couldn't be built.
+ */
+extern int
+_regdfaexec(Reset *rs, char *s, Rune *rp)
+{
+	Dstate *d, *nd;
+	Rune r;
+	char *p;
+
+	if(rs->dinit == nil)
+		rs->dinit = intern(rs, rs->list[0], 0, Dbol, rs->n);
+	d = rs->dinit;
+	if(d == 0)
+		return -2;
+
+	/* Execute machine once for each character, including terminal NUL */
+	do{
+		if(s && rs->skip && d->n == 0 && !(d->flags&Dbol)){
+			p = utfrune(s, rs->skip);
+			if(p == 0)
+				return d->best;
+			s = p;
+		}
+		if(s){
+			r = *(uchar*)s;
+			if(r < Runeself)
+				s++;
+			else
+				s += chartorune(&r, s);
+		}else
+			r = *rp++;
+
+		nd = 0;
+		if(r < Runeself)
+			nd = d->next[rs->cls[r]];
+		if(nd == 0)
+			nd = step(rs, d, r);
+		if(nd == 0)
+			return -2;
+		d = nd;
+	}while(r && d->best > 0);
+	return d->best;
+}
+
+/*
+ *  Runs progp's DFA, building it the first time.
+ *  Returns 1 on a match, 0 if there's none, or -1
+ *  if the DFA can't be used.
+ */
+extern int
+_regexecdfa(Reprog *progp, char *s, Rune *rp)
+{
+	int rv;
+
+	if(progp->set == nil)
+		progp->set = regcompset(&progp, 1);
+	if(progp->set == nil)
+		return -1;
+	rv = _regdfaexec(progp->set, s, rp);
+	if(rv == -2)
+		return -1;
+	return rv == 0;
+}
+
+extern void
+regfree(Reprog *progp)
+{
+	if(progp == nil)
+		return;
+	regfreeset(progp->set);
+	free(progp);
+}
@@ -54,12 +54,12 @@ regexec1(Reprog *progp,	/* program to run */
 				s = p;
 				break;
 			case BOL:
-				if(s == bol)
+				if(s == bol || *(s-1) == '\n')
 					break;
 				p = utfrune(s, '\n');
 				if(p == 0 || s == j->eol)
 					return match;
-				s = p;
+				s = p+1;
 				break;
 			}
 		}
@@ -196,6 +196,15 @@ regexec(Reprog *progp,	/* program to run */
 	Relist relist0[LISTSIZE], relist1[LISTSIZE];
 	int rv;
 
+	/*
+	 *  without subexpressions, the DFA will do
+	 */
+	if(mp == 0 || ms <= 0){
+		rv = _regexecdfa(progp, bol, 0);
+		if(rv >= 0)
+			return rv;
+	}
+
 	/*
  	 *  use user-specified starting/ending location if specified
 	 */
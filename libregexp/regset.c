@@ -0,0 +1,370 @@
+#include <stdlib.h>
+#include "plan9.h"
+#include "regexp9.h"
+#include "regcomp.h"
+
+/*
+ *  Pattern sets: a number of compiled programs joined into one
+ *  machine, which finds the lowest numbered program matching a
+ *  string in a single pass over it.  Programs are matched as by
+ *  regexec, unanchored, and without subexpressions.
+ */
+
+static int
+ninst(Reprog *pp)
+{
+	Reinst *inst;
+
+	for(inst=pp->firstinst; inst->type!=END; inst++)
+		;
+	return inst - pp->firstinst + 1;
+}
+
+/*
+ *  Collects the runes which can begin a match from inst in
+ *  first.  Returns 0 if it could begin with anything else, or
+ *  if finding out takes more than *budget instructions.
+ */
+static int
+firstrunes(Reinst *inst, char *first, int *budget)
+{
+	for(;; inst=inst->u2.next){
+		if(--*budget < 0)
+			return 0;
+		switch(inst->type){
+		case RUNE:
+			if(inst->u1.r >= Runeself)
+				return 0;
+			first[inst->u1.r] = 1;
+			return 1;
+		case LBRA:
+		case RBRA:
+		case NOP:
+			continue;
+		case OR:
+			if(!firstrunes(inst->u1.right, first, budget))
+				return 0;
+			continue;
+		default:
+			return 0;
+		}
+	}
+}
+
+extern Reset*
+regcompset(Reprog **progs, int n)
+{
+	Reset *rs;
+	Reinst *inst, *ip;
+	Reclass *cl;
+	char *first;
+	int *bp;
+	int i, k, m, nin, ncl, budget;
+
+	nin = 0;
+	ncl = 0;
+	for(k=0; k<n; k++){
+		m = ninst(progs[k]);
+		nin += m;
+		for(i=0; i<m; i++)
+			if(progs[k]->firstinst[i].type == CCLASS
+			|| progs[k]->firstinst[i].type == NCCLASS)
+				ncl++;
+	}
+
+	rs = calloc(1, sizeof *rs);
+	if(rs == nil){
+		regerror("out of memory");
+		return nil;
+	}
+	rs->n = n;
+	rs->ninst = nin;
+	rs->inst = malloc((nin+1) * sizeof *rs->inst);
+	rs->class = malloc((ncl+1) * sizeof *rs->class);
+	rs->prog = malloc((nin+1) * sizeof *rs->prog);
+	rs->mark = calloc(nin+1, sizeof *rs->mark);
+	rs->list[0] = malloc((nin+1) * sizeof *rs->list[0]);
+	rs->list[1] = malloc((nin+1) * sizeof *rs->list[1]);
+	rs->start = malloc((n+1) * sizeof *rs->start);
+	if(rs->inst == nil || rs->class == nil || rs->prog == nil || rs->mark == nil
+	|| rs->list[0] == nil || rs->list[1] == nil || rs->start == nil){
+		regfreeset(rs);
+		regerror("out of memory");
+		return nil;
+	}
+
+	/*
+	 *  Copy each program in, relocating its pointers
+	 *  and giving each of its classes a copy of its own.
+	 */
+	ip = rs->inst;
+	cl = rs->class;
+	for(k=0; k<n; k++){
+		m = ninst(progs[k]);
+		for(i=0; i<m; i++){
+			inst = &progs[k]->firstinst[i];
+			ip[i] = *inst;
+			rs->prog[ip - rs->inst + i] = k;
+			if(inst->u2.next)
+				ip[i].u2.next = ip + (inst->u2.next - progs[k]->firstinst);
+			switch(inst->type){
+			case OR:
+				ip[i].u1.right = ip + (inst->u1.right - progs[k]->firstinst);
+				break;
+			case CCLASS:
+			case NCCLASS:
+				*cl = *inst->u1.cp;
+				cl->end = cl->spans + (inst->u1.cp->end - inst->u1.cp->spans);
+				ip[i].u1.cp = cl++;
+				break;
+			}
+		}
+		rs->start[k] = ip + (progs[k]->startinst - progs[k]->firstinst);
+		ip += m;
+	}
+
+	/*
+	 *  Programs which can only start with one of a few runes
+	 *  are only tried where they appear, those anchored to the
+	 *  start of a line only there, and the rest everywhere.
+	 *  Each list is kept in program order.
+	 */
+	first = calloc(n+1, Runeself);
+	if(first == nil){
+		regfreeset(rs);
+		regerror("out of memory");
+		return nil;
+	}
+	m = 0;
+	for(k=0; k<n; k++){
+		budget = 64;
+		if(rs->start[k]->type != BOL
+		&& !firstrunes(rs->start[k], first + k*Runeself, &budget))
+			memset(first + k*Runeself, 0, Runeself);
+		for(i=0; i<Runeself; i++)
+			m += first[k*Runeself + i];
+	}
+	rs->starts = malloc((m+n+1) * sizeof *rs->starts);
+	if(rs->starts == nil){
+		free(first);
+		regfreeset(rs);
+		regerror("out of memory");
+		return nil;
+	}
+	bp = rs->starts;
+	for(i=0; i<Runeself; i++){
+		rs->byrune[i] = bp;
+		for(k=0; k<n; k++)
+			if(first[k*Runeself + i])
+				*bp++ = k;
+		rs->nbyrune[i] = bp - rs->byrune[i];
+	}
+	rs->bol = bp;
+	for(k=0; k<n; k++)
+		if(rs->start[k]->type == BOL)
+			*bp++ = k;
+	rs->nbol = bp - rs->bol;
+	rs->any = bp;
+	for(k=0; k<n; k++)
+		if(rs->start[k]->type != BOL
+		&& memchr(first + k*Runeself, 1, Runeself) == nil)
+			*bp++ = k;
+	rs->nany = bp - rs->any;
+	free(first);
+	_regdfainit(rs);
+	return rs;
+}
+
+extern void
+regfreeset(Reset *rs)
+{
+	if(rs == nil)
+		return;
+	free(rs->inst);
+	free(rs->class);
+	free(rs->prog);
+	free(rs->mark);
+	free(rs->list[0]);
+	free(rs->list[1]);
+	free(rs->start);
+	free(rs->starts);
+	_regdfafree(rs);
+	free(rs);
+}
+
+/*
+ *  Adds inst to a run list, unless it's there already.
+ *  Lists are told apart by the generation they're marked with.
+ */
+static void
+addthread(Reset *rs, Reinst **list, int *n, Reinst *inst, uint gen)
+{
+	int i;
+
+	i = inst - rs->inst;
+	if(rs->mark[i] == gen)
+		return;
+	rs->mark[i] = gen;
+	list[(*n)++] = inst;
+}
+
+/*
+ *  Starts the programs in one of the start lists, stopping
+ *  at the first which could not beat the best match so far.
+ */
+static void
+startall(Reset *rs, int *start, int n, Reinst **list, int *np, int best, uint gen)
+{
+	int i;
+
+	for(i=0; i<n && start[i]<best; i++)
+		addthread(rs, list, np, rs->start[start[i]], gen);
+}
+
+/*
+ *  Runs the threads in tl, and any programs which could start
+ *  here, over one rune.  bol is set if the rune begins a line.
+ *  Surviving threads are added to nl, marked with gen+1; those
+ *  in tl must be marked with gen.  Returns the number of the
+ *  best program matched, which is best if none beats it.
+ */
+extern int
+_resetstep(Reset *rs, Reinst **tl, int ntl, Reinst **nl, int *nnl,
+	Rune r, int bol, int best, uint gen)
+{
+	Reinst *inst;
+	Rune *rp, *ep;
+	int i;
+
+	if(r < Runeself)
+		startall(rs, rs->byrune[r], rs->nbyrune[r], tl, &ntl, best, gen);
+	if(bol)
+		startall(rs, rs->bol, rs->nbol, tl, &ntl, best, gen);
+	startall(rs, rs->any, rs->nany, tl, &ntl, best, gen);
+
+	/* Execute machine until current list is empty */
+	for(i=0; i<ntl; i++){
+		for(inst=tl[i]; rs->prog[inst - rs->inst] < best; inst=inst->u2.next){
+			switch(inst->type){
+			case RUNE:	/* regular character */
+				if(inst->u1.r == r)
+					addthread(rs, nl, nnl, inst->u2.next, gen+1);
+				break;
+			case LBRA:
+			case RBRA:
+			case NOP:
+				continue;
+			case ANY:
+				if(r != '\n')
+					addthread(rs, nl, nnl, inst->u2.next, gen+1);
+				break;
+			case ANYNL:
+				addthread(rs, nl, nnl, inst->u2.next, gen+1);
+				break;
+			case BOL:
+				if(bol)
+					continue;
+				break;
+			case EOL:
+				if(r == 0 || r == '\n')
+					continue;
+				break;
+			case CCLASS:
+				ep = inst->u1.cp->end;
+				for(rp = inst->u1.cp->spans; rp < ep; rp += 2)
+					if(r >= rp[0] && r <= rp[1]){
+						addthread(rs, nl, nnl, inst->u2.next, gen+1);
+						break;
+					}
+				break;
+			case NCCLASS:
+				ep = inst->u1.cp->end;
+				for(rp = inst->u1.cp->spans; rp < ep; rp += 2)
+					if(r >= rp[0] && r <= rp[1])
+						break;
+				if(rp == ep)
+					addthread(rs, nl, nnl, inst->u2.next, gen+1);
+				break;
+			case OR:
+				/* evaluate right choice later */
+				addthread(rs, tl, &ntl, inst->u1.right, gen);
+				continue;
+			case END:	/* Match! */
+				best = rs->prog[inst - rs->inst];
+				break;
+			}
+			break;
+		}
+	}
+	return best;
+}
+
+/*
+ *  Returns the generation to mark the current list with.
+ */
+extern uint
+_resetgen(Reset *rs, int n)
+{
+	if(rs->gen > (1U<<31)){
+		memset(rs->mark, 0, rs->ninst * sizeof *rs->mark);
+		rs->gen = 0;
+	}
+	return rs->gen += n;
+}
+
+static int
+nfaexec(Reset *rs, char *s)
+{
+	Reinst **tl, **nl;
+	Rune r;
+	char *bol;
+	uint gen;
+	int best, ntl, nnl, n, flag;
+
+	best = rs->n;
+	bol = s;
+	flag = 0;
+	ntl = 0;
+
+	/* Current threads are marked gen, those for the next rune gen+1. */
+	gen = _resetgen(rs, 2);
+
+	/* Execute machine once for each character, including terminal NUL */
+	do{
+		r = *(uchar*)s;
+		if(r < Runeself)
+			n = 1;
+		else
+			n = chartorune(&r, s);
+
+		tl = rs->list[flag];
+		nl = rs->list[flag^=1];
+		nnl = 0;
+		best = _resetstep(rs, tl, ntl, nl, &nnl, r, s == bol || s[-1] == '\n', best, gen);
+		if(best == 0)
+			break;
+		ntl = nnl;
+		gen = rs->gen += 1;
+		s += n;
+	}while(r);
+	return best;
+}
+
+/*
+ *  return	the number of the first program
+ *		to match s, or -1 if none does
+ */
+extern int
+regexecset(Reset *rs, char *s)
+{
+	int best;
+
+	if(rs->n == 0)
+		return -1;
+	best = _regdfaexec(rs, s, nil);
+	if(best == -2)
+		best = nfaexec(rs, s);
+	if(best == rs->n)
+		return -1;
+	return best;
+}
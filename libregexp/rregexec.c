@@ -51,13 +51,14 @@ rregexec1(Reprog *progp,	/* program to run */
 				}
 				break;
 			case BOL:
-				if(s == bol)
+				if(s == bol || *(s-1) == '\n')
 					break;
 				while(*s != '\n') {
 					if(*s == 0 || s == j->reol)
 						return match;
 					s++;
 				}
+				s++;
 				break;
 			}
 		}
@@ -177,6 +178,15 @@ rregexec(Reprog *progp,	/* program to run */
 	Relist relist0[LISTSIZE], relist1[LISTSIZE];
 	int rv;
 
+	/*
+	 *  without subexpressions, the DFA will do
+	 */
+	if(mp == 0 || ms <= 0){
+		rv = _regexecdfa(progp, 0, bol);
+		if(rv >= 0)
+			return rv;
+	}
+
 	/*
  	 *  use user-specified starting/ending location if specified
 	 */
@@ -1,5 +1,7 @@
 #include "plan9.h"
 #include <regexp9.h>
+#include <stdlib.h>
+#include <sys/time.h>
 
 struct x
 {
@@ -22,6 +24,76 @@ struct x t[] = {
 	{ 0, 0, 0 },
 };
 
+/*
+ *  Times each pattern against each string with the NFA, which
+ *  regexec uses when asked for matches, and with the DFA, which
+ *  it uses when not.
+ */
+char *benchre[] = {
+	"^Firefox:",
+	"^[^:]*:gimp:",
+	"(MPlayer|VLC|mpv):",
+	":Window [0-9]+$",
+	"[a-z]+@[a-z]+\\.[a-z]+",
+	"(a|b)*abb",
+	0,
+};
+
+char *benchs[] = {
+	"Firefox:Navigator:Mozilla Firefox",
+	"Gimp:gimp:GNU Image Manipulation Program",
+	"URxvt:urxvt:Window 12",
+	"Some:longer:title, which mentions someone@example.org near its end",
+	"abababababababababababababababababababababababababababababababb",
+	0,
+};
+
+double
+now(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void
+bench(int n)
+{
+	Resub rs[1];
+	Reprog *p;
+	double t1, t2;
+	int i, j, k, m;
+
+	for(i = 0; benchre[i]; i++){
+		p = regcomp(benchre[i]);
+		m = 0;
+		for(j = 0; benchs[j]; j++){
+			rs[0].s.sp = rs[0].e.ep = 0;
+			if(regexec(p, benchs[j], rs, 1) != regexec(p, benchs[j], 0, 0))
+				print("%s VIA %s: engines disagree\n", benchs[j], benchre[i]);
+			m += regexec(p, benchs[j], 0, 0);
+		}
+
+		t1 = now();
+		for(k = 0; k < n; k++)
+			for(j = 0; benchs[j]; j++){
+				rs[0].s.sp = rs[0].e.ep = 0;
+				regexec(p, benchs[j], rs, 1);
+			}
+		t1 = now() - t1;
+
+		t2 = now();
+		for(k = 0; k < n; k++)
+			for(j = 0; benchs[j]; j++)
+				regexec(p, benchs[j], 0, 0);
+		t2 = now() - t2;
+
+		print("%-28s %d matched  nfa %6.3fs  dfa %6.3fs\n", benchre[i], m, t1, t2);
+		regfree(p);
+	}
+}
+
 main(int ac, char **av)
 {
 	Resub rs[10];
@@ -29,6 +101,11 @@ main(int ac, char **av)
 	int n;
 	struct x *tp;
 
+	if(ac > 1 && strcmp(av[1], "-b") == 0){
+		bench(ac > 2 ? atoi(av[2]) : 100000);
+		exit(0);
+	}
+
 	for(tp = t; tp->re; tp++)
 		tp->p = regcomp(tp->re);
 
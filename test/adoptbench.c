@@ -0,0 +1,99 @@
+/* Maps a number of clients and times a restart of wmii, from the
+ * write of the exec command until the new instance has adopted the
+ * last of them. Must be run under a running wmii.
+ *
+ *	adoptbench [-n clients] [command]
+ */
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
+#include <fmt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ixp.h>
+#include <util.h>
+#include <x11.h>
+#include "harness.h"
+
+enum {
+	Timeout = 60,
+};
+
+/* The new instance only begins serving once it has scanned every
+ * window, so the first successful stat of the last client's ctl file
+ * marks the end of the restart.
+ */
+static bool
+adopted(Window *w) {
+	IxpClient *c;
+	IxpStat *stat;
+	char *file;
+
+	c = ixp_nsmount("wmii");
+	if(c == nil)
+		return false;
+	file = smprint("/client/%W/ctl", w);
+	stat = ixp_stat(c, file);
+	free(file);
+	ixp_unmount(c);
+	if(stat == nil)
+		return false;
+	ixp_freestat(stat);
+	free(stat);
+	return true;
+}
+
+int
+main(int argc, char *argv[]) {
+	Window **wins;
+	char *cmd, *name;
+	double t;
+	int i, nclient;
+
+	nclient = 500;
+	cmd = "wmii";
+	ARGBEGIN{
+	case 'n':
+		nclient = atoi(EARGF(exit(1)));
+		break;
+	}ARGEND;
+	if(argc > 0)
+		cmd = argv[0];
+
+	xmount();
+	initdisplay();
+	wins = emalloc(nclient * sizeof *wins);
+	for(i=0; i < nclient; i++) {
+		name = smprint("adoptbench %d", i);
+		wins[i] = mkclient(name, "adoptbench");
+		free(name);
+	}
+	mapclients(wins, nclient);
+
+	cmd = smprint("exec %s", cmd);
+	t = now();
+	xwritefile("/ctl", cmd);
+	ixp_unmount(client);
+	/* Wait for the old instance to let go of its socket. */
+	while(adopted(wins[nclient-1])) {
+		if(now() - t > Timeout)
+			fatal("wmii did not restart\n");
+		usleep(1000);
+	}
+	while(!adopted(wins[nclient-1])) {
+		if(now() - t > Timeout)
+			fatal("wmii did not restart\n");
+		usleep(1000);
+	}
+	t = now() - t;
+
+	for(i=0; i < nclient; i++)
+		destroywindow(wins[i]);
+	sync();
+
+	print("clients=%d: restart %.3f s\n", nclient, t);
+	return 0;
+}
+
@@ -0,0 +1,88 @@
+/* Times redraws of long frame titles with the glyph advance cache
+ * enabled and disabled.
+ *
+ *	drawbench [-n rounds] [font]
+ */
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
+#include <fmt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ixp.h>
+#include <util.h>
+#include <x11.h>
+#include "harness.h"
+
+enum {
+	NFrame = 500,
+	TitleLen = 300,
+	TitleWidth = 400,
+};
+
+static char*	titles[NFrame];
+
+static void
+mktitles(void) {
+	char *s;
+	int i, j;
+
+	for(i=0; i < NFrame; i++) {
+		s = emalloc(TitleLen + 1);
+		snprint(s, TitleLen, "%d - ", i);
+		for(j=strlen(s); j < TitleLen; j++)
+			s[j] = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJ"[(i + j*7) % 37];
+		s[TitleLen] = '\0';
+		titles[i] = s;
+	}
+}
+
+static double
+run(Font *font, Image *img, int rounds, bool cache) {
+	Rectangle r;
+	double t;
+	int i, j;
+
+	glyphcache = cache;
+	r = Rect(0, 0, TitleWidth, labelh(font));
+	t = now();
+	for(j=0; j < rounds; j++)
+		for(i=0; i < NFrame; i++)
+			drawstring(img, font, r, West, titles[i], (Color){0});
+	XSync(display, false);
+	return (now() - t) / rounds;
+}
+
+int
+main(int argc, char *argv[]) {
+	Font *font;
+	Image *img;
+	char *name;
+	double on, off;
+	int rounds;
+
+	rounds = 10;
+	name = "fixed";
+	ARGBEGIN{
+	case 'n':
+		rounds = atoi(EARGF(exit(1)));
+		break;
+	}ARGEND;
+	if(argc > 0)
+		name = argv[0];
+
+	initdisplay();
+	font = loadfont(name);
+	if(font == nil)
+		return 1;
+	img = allocimage(TitleWidth, labelh(font), scr.depth);
+	mktitles();
+
+	off = run(font, img, rounds, false);
+	on = run(font, img, rounds, true);
+	print("font=%s frames=%d titlelen=%d rounds=%d\n", name, NFrame, TitleLen, rounds);
+	print("cache off: %.3f ms/redraw\n", off * 1000);
+	print("cache on:  %.3f ms/redraw\n", on * 1000);
+	return 0;
+}
@@ -8,24 +8,25 @@
 	cc -I$inc -I/usr/local/include \
 		-o o.$name \
 		-Wall \
-		$name.c \
+		$name.c harness.c \
 		$obj/util.o \
 		$obj/wmii/map.o \
 		$obj/wmii/x11.o \
-		-L$lib -lfmt -lutf -lbio \
+		-L$lib -lixp -lfmt -lutf -lbio \
 		-L/usr/local/lib -lX11 -lXext \
 
 	exec o.$name
 #endif
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
 #include <fmt.h>
 #include <stdarg.h>
 #include <stdbool.h>
 #include <unistd.h>
+#include <ixp.h>
 #include <util.h>
 #include <x11.h>
-
-char buffer[8196];
-void debug() {}
+#include "harness.h"
 
 static Window*	win;
 
@@ -44,9 +45,9 @@ draw(Window *w) {
 	r = w->r;
 	r = rectsubpt(r, r.min);
 
-	fill(w, r, 0UL);
-	border(w, Rect(3, 3, 97, 97), 2, ~0UL);
-	border(w, Rect(8, 8, 92, 92), 2, ~0UL);
+	fill(w, r, (Color){0});
+	border(w, Rect(3, 3, 97, 97), 2, (Color){~0UL});
+	border(w, Rect(8, 8, 92, 92), 2, (Color){~0UL});
 	sync();
 }
 
@@ -56,7 +57,7 @@ setgravity(Window *w, long gravity) {
 
 	wmh.flags = PWinGravity;
 	wmh.win_gravity = gravity;
-	XSetWMNormalHints(display, w->w, &wmh);
+	XSetWMNormalHints(display, w->xid, &wmh);
 }
 
 static void
@@ -90,12 +91,12 @@ main(void) {
 	win = createwindow(&scr.root,
 				Rect(0, 0, 100, 100), scr.depth, InputOutput,
 				&wa, CWEventMask | CWBackPixmap);
-	XSelectInput(display, win->w, ExposureMask);
+	XSelectInput(display, win->xid, ExposureMask);
 
 	wmh.flags = PMinSize|PMaxSize|USPosition;
 	wmh.min_width = wmh.max_width = 100;
 	wmh.min_height = wmh.max_height = 100;
-	XSetWMNormalHints(display, win->w, &wmh);
+	XSetWMNormalHints(display, win->xid, &wmh);
 
 	mapwin(win);
 	raisewin(win);
@@ -0,0 +1,154 @@
+/* Fixtures shared by the test programs, most of which drive a
+ * running wmii through X and 9P.
+ */
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
+#include <fmt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <ixp.h>
+#include <util.h>
+#include <x11.h>
+#include "harness.h"
+
+/* Wanted by x11.o. */
+char buffer[8196];
+ErrorCode ignored_xerrors[] = { {0, 0} };
+
+IxpClient*	client;
+
+static IxpCFid*	evfid;
+static char	evbuf[8192];
+static int	evlen;
+
+double
+now(void) {
+	struct timeval tv;
+
+	gettimeofday(&tv, nil);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+void
+xmount(void) {
+	client = ixp_nsmount("wmii");
+	if(client == nil)
+		fatal("can't mount wmii: %r\n");
+}
+
+IxpCFid*
+xopen(char *file, int mode) {
+	IxpCFid *fid;
+
+	fid = ixp_open(client, file, mode);
+	if(fid == nil)
+		fatal("can't open file '%s': %r\n", file);
+	return fid;
+}
+
+void
+xwrite(IxpCFid *fid, char *data) {
+	int n;
+
+	n = strlen(data);
+	if(ixp_write(fid, data, n) != n)
+		fatal("can't write: %r\n");
+}
+
+void
+xwritefile(char *file, char *data) {
+	IxpCFid *fid;
+
+	fid = xopen(file, P9_OWRITE);
+	xwrite(fid, data);
+	ixp_close(fid);
+}
+
+/* Opens /event. Only events sent after the first call are seen by
+ * nextevent.
+ */
+void
+openevent(void) {
+	if(evfid == nil)
+		evfid = xopen("/event", P9_OREAD);
+}
+
+/* Returns the next line read from /event, without its newline. */
+char*
+nextevent(void) {
+	static char line[sizeof evbuf];
+	char *p;
+	int n;
+
+	openevent();
+	while((p = memchr(evbuf, '\n', evlen)) == nil) {
+		if(evlen == sizeof evbuf)
+			evlen = 0;
+		n = ixp_read(evfid, evbuf + evlen, sizeof evbuf - evlen);
+		if(n <= 0)
+			fatal("can't read /event: %r\n");
+		evlen += n;
+	}
+	*p++ = '\0';
+	strcpy(line, evbuf);
+	evlen -= p - evbuf;
+	memmove(evbuf, p, evlen);
+	return line;
+}
+
+void
+waitevent(char *want) {
+	while(strcmp(nextevent(), want))
+		;
+}
+
+/* Creates, without mapping, a window for wmii to manage. */
+Window*
+mkclient(char *name, char *tags) {
+	Window *w;
+	WinAttr wa;
+
+	wa.override_redirect = false;
+	w = createwindow(&scr.root, Rect(0, 0, 64, 64), scr.depth, InputOutput,
+			 &wa, CWOverrideRedirect);
+
+	changeprop_string(w, "WM_NAME", name);
+	changeprop_string(w, "_WMII_TAGS", tags);
+	changeprop_char(w, "WM_CLASS", "STRING",
+			(char[]){"wmiitest\0WmiiTest\0"}, sizeof "wmiitest\0WmiiTest");
+	return w;
+}
+
+/* Maps n windows, and waits until wmii has announced, on /event,
+ * that it manages every one of them.
+ */
+void
+mapclients(Window **wins, int n) {
+	bool *seen;
+	char *ev;
+	ulong xid;
+	int i, left;
+
+	openevent();
+	for(i=0; i < n; i++)
+		mapwin(wins[i]);
+	sync();
+
+	seen = emallocz(n * sizeof *seen);
+	for(left=n; left > 0;) {
+		ev = nextevent();
+		if(strncmp(ev, "CreateClient ", 13))
+			continue;
+		xid = strtoul(ev + 13, nil, 0);
+		for(i=0; i < n; i++)
+			if(!seen[i] && wins[i]->xid == xid) {
+				seen[i] = true;
+				left--;
+				break;
+			}
+	}
+	free(seen);
+}
@@ -0,0 +1,16 @@
+/* Fixtures shared by the test programs. Those which talk to wmii
+ * must include <ixp.h> and <x11.h> first.
+ */
+
+extern IxpClient*	client;
+
+Window*		mkclient(char*, char*);
+void		mapclients(Window**, int);
+char*		nextevent(void);
+double		now(void);
+void		openevent(void);
+void		waitevent(char*);
+void		xmount(void);
+IxpCFid*	xopen(char*, int);
+void		xwrite(IxpCFid*, char*);
+void		xwritefile(char*, char*);
@@ -0,0 +1,104 @@
+/* Maps a large number of clients on a single tag and checks that
+ * /tag/<tag>/index lists every one of them, and that the tag's ctl
+ * file reads back completely. Must be run under a running wmii.
+ *
+ *	index [-n clients] [tag]
+ */
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
+#include <fmt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ixp.h>
+#include <util.h>
+#include <x11.h>
+#include "harness.h"
+
+static char*
+readall(char *file, long *np) {
+	IxpCFid *fid;
+	char *buf;
+	long n, size;
+	int count;
+
+	fid = xopen(file, P9_OREAD);
+	n = 0;
+	size = fid->iounit;
+	buf = emalloc(size + 1);
+	while((count = ixp_read(fid, buf + n, fid->iounit)) > 0) {
+		n += count;
+		if(n + fid->iounit > size) {
+			size <<= 1;
+			buf = erealloc(buf, size + 1);
+		}
+	}
+	ixp_close(fid);
+	if(count == -1)
+		fatal("can't read file '%s': %r\n", file);
+	buf[n] = '\0';
+	*np = n;
+	return buf;
+}
+
+int
+main(int argc, char *argv[]) {
+	Window **wins;
+	char *tag, *file, *buf, *id, *name;
+	long n;
+	int i, nclient, missing;
+
+	nclient = 1000;
+	tag = "indextest";
+	ARGBEGIN{
+	case 'n':
+		nclient = atoi(EARGF(exit(1)));
+		break;
+	}ARGEND;
+	if(argc > 0)
+		tag = argv[0];
+
+	xmount();
+	initdisplay();
+	wins = emalloc(nclient * sizeof *wins);
+	for(i=0; i < nclient; i++) {
+		name = smprint("client %d: %0100d", i, i);
+		wins[i] = mkclient(name, tag);
+		free(name);
+	}
+	mapclients(wins, nclient);
+
+	file = smprint("/tag/%s/index", tag);
+	buf = readall(file, &n);
+	print("%s: %ld bytes\n", file, n);
+
+	missing = 0;
+	for(i=0; i < nclient; i++) {
+		id = smprint(" %W ", wins[i]);
+		if(strstr(buf, id) == nil) {
+			fprint(2, "missing client %W\n", wins[i]);
+			missing++;
+		}
+		free(id);
+	}
+	free(buf);
+	free(file);
+
+	file = smprint("/tag/%s/ctl", tag);
+	buf = readall(file, &n);
+	if(strncmp(buf, tag, strlen(tag)) || buf[n-1] != '\n') {
+		fprint(2, "%s: truncated\n", file);
+		missing++;
+	}
+	free(buf);
+	free(file);
+
+	for(i=0; i < nclient; i++)
+		destroywindow(wins[i]);
+	sync();
+
+	print("%d/%d clients listed\n", nclient - missing, nclient);
+	return missing > 0;
+}
@@ -0,0 +1,132 @@
+/* Times wimenu's filtering of a generated list as a filter is typed
+ * one character at a time, both incrementally and rescanning the
+ * whole list for each keystroke.
+ *
+ *	menubench [-fi] [-n lines] [filter]
+ */
+#define EXTERN
+#include "../cmd/menu/dat.h"
+#include <sys/time.h>
+#include "../cmd/menu/fns.h"
+
+void
+debug(int flag, const char *fmt, ...) {
+	USED(flag, fmt);
+}
+
+static char*	words[] = {
+	"bin", "lib", "share", "local", "usr", "opt", "x11", "doc",
+	"python", "perl", "gnome", "kde", "wmii", "term", "config",
+	"Makefile", "README", "Xresources", "include", "src",
+};
+
+static double
+now(void) {
+	struct timeval tv;
+
+	gettimeofday(&tv, nil);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+static Item*
+mkitems(int n) {
+	Item *i, *first, **ip;
+	char buf[128], *p;
+	ulong seed;
+	int j, k, nw;
+
+	seed = 1;
+	first = nil;
+	ip = &first;
+	for(j=0; j < n; j++) {
+		p = buf;
+		nw = 2 + j % 4;
+		for(k=0; k < nw; k++) {
+			seed = seed * 1103515245 + 12345;
+			p = seprint(p, buf+sizeof buf, "/%s", words[(seed >> 16) % nelem(words)]);
+		}
+		seprint(p, buf+sizeof buf, "%d", j);
+
+		i = emallocz(sizeof *i);
+		i->string = estrdup(buf);
+		i->retstring = i->string;
+		i->match = i->string;
+		if(ignorecase)
+			i->match = filter_lower(estrdup(i->string));
+		i->len = strlen(i->string);
+		*ip = i;
+		ip = &i->next_link;
+	}
+	return first;
+}
+
+static int
+count(Item *i) {
+	Item *j;
+	int n;
+
+	if(i->string == nil)
+		return 0;
+	n = 1;
+	for(j=i->next; j != i; j=j->next)
+		n++;
+	return n;
+}
+
+static double
+run(Item *items, char *filter, bool incremental, int *nmatch) {
+	char *buf;
+	double t;
+	int n, len;
+
+	len = strlen(filter);
+	buf = emallocz(len + 1);
+	filter_reset();
+	t = now();
+	for(n=1; n <= len; n++) {
+		memcpy(buf, filter, n);
+		if(!incremental)
+			filter_reset();
+		*nmatch = count(filter_list(items, buf));
+	}
+	t = now() - t;
+	free(buf);
+	return t / len;
+}
+
+int
+main(int argc, char *argv[]) {
+	Item *items;
+	char *filter;
+	double inc, full;
+	int n, m1, m2;
+
+	quotefmtinstall();
+	n = 500000;
+	filter = "binwmii";
+	ARGBEGIN{
+	case 'f':
+		fuzzy = true;
+		break;
+	case 'i':
+		ignorecase = true;
+		break;
+	case 'n':
+		n = atoi(EARGF(exit(1)));
+		break;
+	}ARGEND;
+	if(argc > 0)
+		filter = argv[0];
+	if(!fuzzy && argc == 0)
+		filter = "/usr/lib/wmii";
+
+	items = mkitems(n);
+	full = run(items, filter, false, &m1);
+	inc = run(items, filter, true, &m2);
+
+	print("lines=%d filter=%q fuzzy=%d ignorecase=%d matches=%d\n",
+	      n, filter, fuzzy, ignorecase, m2);
+	print("rescan:      %.3f ms/keystroke\n", full * 1000);
+	print("incremental: %.3f ms/keystroke\n", inc * 1000);
+	return m1 != m2;
+}
@@ -0,0 +1,131 @@
+/* Times finding the first of a large set of rules to match a
+ * window's props, trying each rule's regex in turn as wmii once did,
+ * and with the rules compiled into a single set.
+ *
+ *	rulebench [-r rules] [-n props] [-i iterations]
+ */
+#include <fmt.h>
+#include <regexp9.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+#include <util.h>
+
+static double
+now(void) {
+	struct timeval tv;
+
+	gettimeofday(&tv, nil);
+	return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+/* The usual shapes of tagrules. */
+static char*
+mkrule(int i) {
+	switch(i % 4) {
+	case 0:
+		return smprint("^App%d:", i);
+	case 1:
+		return smprint("^[^:]*:tool%d:", i);
+	case 2:
+		return smprint("(Viewer|Editor)%d", i);
+	default:
+		return smprint(":Window %d$", i);
+	}
+}
+
+static char*
+mkprops(int i, int nrule) {
+	int r;
+
+	r = rand() % (nrule * 2);
+	switch(r % 4) {
+	case 0:
+		return smprint("App%d:app:Some title %d", r, i);
+	case 1:
+		return smprint("Tool:tool%d:Another title", r);
+	case 2:
+		return smprint("Something:something:Editor%d", r);
+	default:
+		return smprint("Term:term:Window %d", r);
+	}
+}
+
+static int
+sequential(Reprog **progs, int n, char *s) {
+	int i;
+
+	for(i=0; i < n; i++)
+		if(regexec(progs[i], s, nil, 0))
+			return i;
+	return -1;
+}
+
+int
+main(int argc, char *argv[]) {
+	Reprog **progs;
+	Reset *set;
+	char **props, *re;
+	double t1, t2;
+	int i, j, nrule, nprops, niter, nmatch;
+
+	nrule = 1000;
+	nprops = 1000;
+	niter = 5;
+	ARGBEGIN{
+	case 'r':
+		nrule = atoi(EARGF(exit(1)));
+		break;
+	case 'n':
+		nprops = atoi(EARGF(exit(1)));
+		break;
+	case 'i':
+		niter = atoi(EARGF(exit(1)));
+		break;
+	}ARGEND;
+
+	progs = emalloc(nrule * sizeof *progs);
+	for(i=0; i < nrule; i++) {
+		re = mkrule(i);
+		progs[i] = regcomp(re);
+		if(progs[i] == nil)
+			fatal("can't compile %s\n", re);
+		free(re);
+	}
+	props = emalloc(nprops * sizeof *props);
+	for(i=0; i < nprops; i++)
+		props[i] = mkprops(i, nrule);
+
+	t1 = now();
+	set = regcompset(progs, nrule);
+	t1 = now() - t1;
+	print("compile: %.3f ms\n", t1 * 1000);
+
+	nmatch = 0;
+	for(i=0; i < nprops; i++) {
+		j = sequential(progs, nrule, props[i]);
+		if(regexecset(set, props[i]) != j)
+			fatal("mismatch: %s: %d != %d\n", props[i], regexecset(set, props[i]), j);
+		if(j >= 0)
+			nmatch++;
+	}
+
+	t1 = now();
+	for(j=0; j < niter; j++)
+		for(i=0; i < nprops; i++)
+			sequential(progs, nrule, props[i]);
+	t1 = now() - t1;
+
+	t2 = now();
+	for(j=0; j < niter; j++)
+		for(i=0; i < nprops; i++)
+			regexecset(set, props[i]);
+	t2 = now() - t2;
+
+	print("rules=%d props=%d matched=%d\n", nrule, nprops, nmatch);
+	print("sequential: %.3f s, %.1f us/match\n", t1, t1 * 1e6 / (niter * nprops));
+	print("set:        %.3f s, %.1f us/match\n", t2, t2 * 1e6 / (niter * nprops));
+	return 0;
+}
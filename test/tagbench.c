@@ -0,0 +1,68 @@
+/* Maps a number of clients, some of them with regex tags, and times
+ * the creation of many new tags. Must be run under a running wmii.
+ *
+ *	tagbench [-c clients] [-t tags]
+ */
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
+#include <fmt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ixp.h>
+#include <util.h>
+#include <x11.h>
+#include "harness.h"
+
+int
+main(int argc, char *argv[]) {
+	Window **wins;
+	char *file, *tag;
+	double t;
+	int i, j, nclient, ntag;
+
+	nclient = 500;
+	ntag = 300;
+	ARGBEGIN{
+	case 'c':
+		nclient = atoi(EARGF(exit(1)));
+		break;
+	case 't':
+		ntag = atoi(EARGF(exit(1)));
+		break;
+	}ARGEND;
+
+	xmount();
+	initdisplay();
+	wins = emalloc(nclient * sizeof *wins);
+	/* Every tenth client follows every tenth tag. */
+	for(i=0; i < nclient; i++)
+		if(i % 10 == 0)
+			wins[i] = mkclient("tagbench", "tagbench+/^tagbench-[0-9]*0$/");
+		else
+			wins[i] = mkclient("tagbench", "tagbench");
+	mapclients(wins, nclient);
+
+	/* Each new tag is added to one client without a regex. */
+	t = now();
+	for(i=0; i < ntag; i++) {
+		j = i % nclient;
+		if(j % 10 == 0)
+			j = (j + 1) % nclient;
+		file = smprint("/client/%W/tags", wins[j]);
+		tag = smprint("+tagbench-%d", i);
+		xwritefile(file, tag);
+		free(file);
+		free(tag);
+	}
+	t = now() - t;
+
+	for(i=0; i < nclient; i++)
+		destroywindow(wins[i]);
+	sync();
+
+	print("clients=%d tags=%d: %.3f s, %.3f ms/tag\n",
+	      nclient, ntag, t, t * 1000 / ntag);
+	return 0;
+}
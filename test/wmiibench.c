@@ -0,0 +1,336 @@
+/* Drives a running wmii through X and 9P and reports, one
+ * "<name> <value>" pair per line:
+ *
+ *	map.*		from MapWindow until the CreateClient event
+ *	view.*		from a 'view' ctl command until the FocusTag event
+ *	ctl.*		ctl commands per second
+ *	batch.restacks	restacks caused by one many-line tag ctl write,
+ *			which must be 1
+ *	event.*		from a write to /event until it's read back
+ *	rss.peak	wmii's peak resident set, in kB, when -p is given
+ *
+ * Latencies are given as count, mean, median, 95th percentile and
+ * maximum, in microseconds. Normally run by ./bench, under Xvfb.
+ *
+ *	wmiibench [-n clients] [-t tags] [-r rounds] [-l title]
+ *		  [-h none|fixed|urgent] [-p pid]
+ *
+ * The title is a format, given the client's number.
+ */
+#define IXP_NO_P9_
+#define IXP_P9_STRUCTS
+#include <fmt.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <ixp.h>
+#include <util.h>
+#include <x11.h>
+#include "harness.h"
+
+enum {
+	Timeout = 300,
+	BatchLines = 50,
+};
+
+enum {
+	HNone,
+	HFixed,
+	HUrgent,
+};
+
+typedef struct Sample Sample;
+struct Sample {
+	double*	v;
+	int	n;
+};
+
+static void
+sample(Sample *s, double v) {
+	if((s->n & (s->n - 1)) == 0)
+		s->v = erealloc(s->v, (s->n ? s->n * 2 : 1) * sizeof *s->v);
+	s->v[s->n++] = v;
+}
+
+static int
+cmpdouble(const void *a, const void *b) {
+	double x, y;
+
+	x = *(double*)a;
+	y = *(double*)b;
+	return x < y ? -1 : x > y;
+}
+
+static void
+report(char *name, Sample *s) {
+	double total;
+	int i;
+
+	print("%s.count %d\n", name, s->n);
+	if(s->n == 0)
+		return;
+	qsort(s->v, s->n, sizeof *s->v, cmpdouble);
+	total = 0;
+	for(i=0; i < s->n; i++)
+		total += s->v[i];
+	print("%s.mean %.0f\n", name, total / s->n * 1e6);
+	print("%s.median %.0f\n", name, s->v[s->n / 2] * 1e6);
+	print("%s.p95 %.0f\n", name, s->v[s->n * 95 / 100] * 1e6);
+	print("%s.max %.0f\n", name, s->v[s->n - 1] * 1e6);
+}
+
+static Window*
+mkbenchclient(int i, char *title, int ntag, int hints) {
+	Window *w;
+	long h[18];
+	char *name, *tags;
+
+	name = smprint(title, i);
+	tags = smprint("wmiibench-%d", i % ntag);
+	w = mkclient(name, tags);
+	free(name);
+	free(tags);
+
+	memset(h, 0, sizeof h);
+	switch(hints) {
+	case HFixed:
+		/* PMinSize|PMaxSize, with min == max. */
+		h[0] = (1<<4) | (1<<5);
+		h[5] = h[7] = 64;
+		h[6] = h[8] = 64;
+		changeprop_long(w, "WM_NORMAL_HINTS", "WM_SIZE_HINTS", h, 18);
+		break;
+	case HUrgent:
+		/* XUrgencyHint */
+		h[0] = 1<<8;
+		changeprop_long(w, "WM_HINTS", "WM_HINTS", h, 9);
+		break;
+	}
+	return w;
+}
+
+static char*
+readgrabmod(void) {
+	static char grabmod[64];
+	IxpCFid *fid;
+	char buf[4096];
+	char *p;
+	int n;
+
+	fid = xopen("/ctl", P9_OREAD);
+	n = ixp_read(fid, buf, sizeof buf - 1);
+	ixp_close(fid);
+	buf[max(n, 0)] = '\0';
+	p = strstr(buf, "grabmod ");
+	if(p == nil || sscanf(p, "grabmod %63s", grabmod) != 1)
+		fatal("can't find grabmod in /ctl\n");
+	return grabmod;
+}
+
+/* Returns the value of a plain counter from /debug/stats. */
+static long
+readstat(char *name) {
+	IxpCFid *fid;
+	char *buf, *key, *p;
+	long n, size, val;
+	int count;
+
+	/* The leading newline lets every line be found as "\n<name> ". */
+	fid = xopen("/debug/stats", P9_OREAD);
+	n = 1;
+	size = fid->iounit;
+	buf = emalloc(size + 1);
+	buf[0] = '\n';
+	while((count = ixp_read(fid, buf + n, size - n)) > 0) {
+		n += count;
+		if(n == size) {
+			size <<= 1;
+			buf = erealloc(buf, size + 1);
+		}
+	}
+	ixp_close(fid);
+	buf[n] = '\0';
+
+	key = smprint("\n%s ", name);
+	p = strstr(buf, key);
+	if(p == nil)
+		fatal("can't find %s in /debug/stats\n", name);
+	val = strtol(p + strlen(key), nil, 10);
+	free(key);
+	free(buf);
+	return val;
+}
+
+/* Reads VmHWM from /proc, on systems which have it. */
+static long
+peakrss(int pid) {
+	char line[256];
+	FILE *f;
+	char *file;
+	long kb;
+
+	file = smprint("/proc/%d/status", pid);
+	f = fopen(file, "r");
+	free(file);
+	if(f == nil)
+		return -1;
+	kb = -1;
+	while(fgets(line, sizeof line, f))
+		if(sscanf(line, "VmHWM: %ld", &kb) == 1)
+			break;
+	fclose(f);
+	return kb;
+}
+
+int
+main(int argc, char *argv[]) {
+	IxpCFid *ctl, *evout, *fid;
+	Sample map, view, event;
+	Window **wins;
+	Fmt fmt;
+	char *title, *s, *p;
+	double t, ctltime;
+	long restacks;
+	int i, n, nclient, ntag, nround, hints, pid;
+
+	nclient = 200;
+	ntag = 8;
+	nround = 200;
+	title = "wmiibench %d";
+	hints = HNone;
+	pid = 0;
+	ARGBEGIN{
+	case 'n':
+		nclient = atoi(EARGF(exit(1)));
+		break;
+	case 't':
+		ntag = atoi(EARGF(exit(1)));
+		break;
+	case 'r':
+		nround = atoi(EARGF(exit(1)));
+		break;
+	case 'l':
+		title = EARGF(exit(1));
+		break;
+	case 'h':
+		s = EARGF(exit(1));
+		if(!strcmp(s, "fixed"))
+			hints = HFixed;
+		else if(!strcmp(s, "urgent"))
+			hints = HUrgent;
+		else if(strcmp(s, "none"))
+			fatal("bad hints: %s\n", s);
+		break;
+	case 'p':
+		pid = atoi(EARGF(exit(1)));
+		break;
+	default:
+		fatal("usage: wmiibench [-n clients] [-t tags] [-r rounds] [-l title] "
+		      "[-h none|fixed|urgent] [-p pid]\n");
+	}ARGEND;
+	if(nclient < 1 || ntag < 2)
+		fatal("need at least one client and two tags\n");
+
+	/* A wedged wmii shouldn't wedge the benchmark. */
+	alarm(Timeout);
+
+	xmount();
+	openevent();
+	evout = xopen("/event", P9_OWRITE);
+	ctl = xopen("/ctl", P9_OWRITE);
+
+	initdisplay();
+
+	memset(&map, 0, sizeof map);
+	memset(&view, 0, sizeof view);
+	memset(&event, 0, sizeof event);
+
+	wins = emalloc(nclient * sizeof *wins);
+	for(i=0; i < nclient; i++) {
+		wins[i] = mkbenchclient(i, title, ntag, hints);
+		s = smprint("CreateClient %W", wins[i]);
+		t = now();
+		mapwin(wins[i]);
+		sync();
+		waitevent(s);
+		sample(&map, now() - t);
+		free(s);
+	}
+
+	/* Switching to the selected view is a no-op, without an event,
+	 * so start from somewhere else.
+	 */
+	xwrite(ctl, "view wmiibench-idle\n");
+	waitevent("FocusTag wmiibench-idle");
+	for(i=0; i < nround; i++) {
+		s = smprint("view wmiibench-%d\n", i % ntag);
+		t = now();
+		xwrite(ctl, s);
+		/* Without its newline, this is the event we wait for. */
+		s[strlen(s) - 1] = '\0';
+		p = smprint("FocusTag %s", s + 5);
+		waitevent(p);
+		sample(&view, now() - t);
+		free(p);
+		free(s);
+	}
+
+	/* Rewrite the current grabmod, which touches nothing else. */
+	s = smprint("grabmod %s\n", readgrabmod());
+	n = nround * 10;
+	t = now();
+	for(i=0; i < n; i++)
+		xwrite(ctl, s);
+	ctltime = now() - t;
+	free(s);
+
+	/* Each line of a tag ctl write may change the layout, and the
+	 * selects read it, but only the end of the write restacks.
+	 */
+	fmtstrinit(&fmt);
+	for(i=0; i < BatchLines / 2; i++)
+		fmtprint(&fmt, "colmode sel %s\nselect down\n",
+			 (i & 1) ? "default" : "stack");
+	s = fmtstrflush(&fmt);
+	restacks = readstat("view_restack");
+	fid = xopen("/tag/sel/ctl", P9_OWRITE);
+	xwrite(fid, s);
+	ixp_close(fid);
+	restacks = readstat("view_restack") - restacks;
+	free(s);
+
+	for(i=0; i < nround; i++) {
+		s = smprint("WmiiBench %d\n", i);
+		t = now();
+		xwrite(evout, s);
+		s[strlen(s) - 1] = '\0';
+		waitevent(s);
+		sample(&event, now() - t);
+		free(s);
+	}
+
+	for(i=0; i < nclient; i++)
+		destroywindow(wins[i]);
+	sync();
+
+	print("clients %d\n", nclient);
+	print("tags %d\n", ntag);
+	report("map", &map);
+	report("view", &view);
+	print("ctl.count %d\n", n);
+	print("ctl.persec %.0f\n", n / ctltime);
+	report("event", &event);
+	print("batch.restacks %ld\n", restacks);
+	if(pid)
+		print("rss.peak %ld\n", peakrss(pid));
+	if(restacks != 1) {
+		fprint(2, "wmiibench: a %d line tag ctl write restacked %ld times\n",
+		       BatchLines, restacks);
+		return 1;
+	}
+	return 0;
+}
+